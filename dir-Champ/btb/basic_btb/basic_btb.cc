@@ -10,6 +10,7 @@
 #include <bitset>
 #include <deque>
 #include <map>
+#include <vector>
 
 #include "msl/lru_table.h"
 #include "ooo_cpu.h"
@@ -27,11 +28,9 @@ enum class branch_info {
 constexpr std::size_t BTB_SET = 1024;
 constexpr std::size_t BTB_WAY = 8;
 
-#ifdef SKIP_DISPATCH
-constexpr std::size_t BTB_INDIRECT_SIZE = 4096 - (HDBT_SIZE + BYTECODE_BTB_SIZE);
-#else
-constexpr std::size_t BTB_INDIRECT_SIZE = 4096 ;
-#endif
+// When skipping dispatch the indirect BTB gives up the bits the bytecode structures in use take
+constexpr std::size_t BTB_INDIRECT_SIZE = 4096;
+constexpr uint64_t BTB_INDIRECT_ENTRY_BITS = 64;
 
 constexpr std::size_t RAS_SIZE = 64;
 constexpr std::size_t CALL_SIZE_TRACKERS = 1024;
@@ -46,7 +45,7 @@ struct btb_entry_t {
 };
 
 std::map<O3_CPU*, champsim::msl::lru_table<btb_entry_t>> BTB;
-std::map<O3_CPU*, std::array<uint64_t, BTB_INDIRECT_SIZE>> INDIRECT_BTB;
+std::map<O3_CPU*, std::vector<uint64_t>> INDIRECT_BTB;
 std::map<O3_CPU*, std::bitset<champsim::lg2(BTB_INDIRECT_SIZE)>> CONDITIONAL_HISTORY;
 std::map<O3_CPU*, std::deque<uint64_t>> RAS;
 /*
@@ -54,12 +53,39 @@ std::map<O3_CPU*, std::deque<uint64_t>> RAS;
  * find the target for a call's return, since calls may have different sizes.
  */
 std::map<O3_CPU*, std::array<uint64_t, CALL_SIZE_TRACKERS>> CALL_SIZE;
+
+template <champsim::dispatch_mode MODE>
+std::size_t indirect_btb_size(const O3_CPU& cpu)
+{
+  if constexpr (!champsim::skips_dispatch(MODE)) {
+    return BTB_INDIRECT_SIZE;
+  } else {
+    auto bytecode_bits = cpu.bytecode_module.storage().total();
+    auto given_up = static_cast<std::size_t>((bytecode_bits + BTB_INDIRECT_ENTRY_BITS - 1) / BTB_INDIRECT_ENTRY_BITS);
+    return BTB_INDIRECT_SIZE - std::min(given_up, BTB_INDIRECT_SIZE - 1);
+  }
+}
 } // namespace
 
 void O3_CPU::initialize_btb()
 {
   ::BTB.insert({this, champsim::msl::lru_table<btb_entry_t>{BTB_SET, BTB_WAY}});
-  std::fill(std::begin(::INDIRECT_BTB[this]), std::end(::INDIRECT_BTB[this]), 0);
+  auto indirect_size = BTB_INDIRECT_SIZE;
+  switch (dispatch) {
+  case champsim::dispatch_mode::NO_SKIP:
+    indirect_size = ::indirect_btb_size<champsim::dispatch_mode::NO_SKIP>(*this);
+    break;
+  case champsim::dispatch_mode::SKIP:
+    indirect_size = ::indirect_btb_size<champsim::dispatch_mode::SKIP>(*this);
+    break;
+  case champsim::dispatch_mode::IDEAL:
+    indirect_size = ::indirect_btb_size<champsim::dispatch_mode::IDEAL>(*this);
+    break;
+  case champsim::dispatch_mode::MINIMAL:
+    indirect_size = ::indirect_btb_size<champsim::dispatch_mode::MINIMAL>(*this);
+    break;
+  }
+  ::INDIRECT_BTB[this].assign(indirect_size, 0);
   std::fill(std::begin(::CALL_SIZE[this]), std::end(::CALL_SIZE[this]), 4);
   ::CONDITIONAL_HISTORY[this] = 0;
 }
@@ -54,6 +54,50 @@ dib_builder_parts = {
     'window_size': '  .dib_window({DIB[window_size]})'
 }
 
+bb_builder_parts = {
+    'rows': '  .bb_rows({bytecode_buffer[rows]})',
+    'row_size': '  .bb_row_size({bytecode_buffer[row_size]})',
+    'runahead_depth': '  .bb_runahead_depth({bytecode_buffer[runahead_depth]})',
+    'runahead_confidence': '  .bb_runahead_confidence({bytecode_buffer[runahead_confidence]})',
+    'dual_path_confidence': '  .bb_dual_path_confidence({bytecode_buffer[dual_path_confidence]})',
+    'fill_width': '  .bb_fill_width({bytecode_buffer[fill_width]})'
+}
+
+hdbt_builder_parts = {
+    'sets': '  .hdbt_sets({bytecode_hdbt[sets]})',
+    'ways': '  .hdbt_ways({bytecode_hdbt[ways]})',
+    'prefetch_depth': '  .hdbt_prefetch_depth({bytecode_hdbt[prefetch_depth]})'
+}
+
+dbtb_builder_parts = {
+    'entries': '  .dbtb_entries({bytecode_btb[entries]})',
+    'oparg_sets': '  .dbtb_oparg_sets({bytecode_btb[oparg_sets]})',
+    'oparg_ways': '  .dbtb_oparg_ways({bytecode_btb[oparg_ways]})',
+    'direction_entries': '  .bytecode_direction_entries({bytecode_btb[direction_entries]})',
+    'direction_history': '  .bytecode_direction_history({bytecode_btb[direction_history]})'
+}
+
+ras_builder_parts = {
+    'depth': '  .bytecode_ras_depth({bytecode_ras[depth]})'
+}
+
+loop_builder_parts = {
+    'entries': '  .bytecode_loop_entries({bytecode_loop[entries]})',
+    'prefetch_distance': '  .bytecode_loop_prefetch_distance({bytecode_loop[prefetch_distance]})'
+}
+
+bytecode_l1_builder_parts = {
+    'size': '  .bytecode_l1_size({bytecode_l1[size]})',
+    'ways': '  .bytecode_l1_ways({bytecode_l1[ways]})',
+    'latency': '  .bytecode_l1_latency({bytecode_l1[latency]})',
+    'mshr_size': '  .bytecode_l1_mshr_size({bytecode_l1[mshr_size]})'
+}
+
+fusion_builder_parts = {
+    'entries': '  .fusion_entries({bytecode_fusion[entries]})',
+    'threshold': '  .fusion_threshold({bytecode_fusion[threshold]})'
+}
+
 cache_builder_parts = {
     'frequency': '.frequency({frequency})',
     'sets': '.sets({sets})',
@@ -191,11 +235,42 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield '.index({_index})'.format(**cpu)
         yield '.frequency({frequency})'.format(**cpu)
         yield '.l1i(&{L1I})'.format(**cpu)
+        yield '.l1d(&{L1D})'.format(**cpu)
         yield '.l1i_bandwidth({L1I}.MAX_TAG)'.format(**cpu)
         yield '.l1d_bandwidth({L1D}.MAX_TAG)'.format(**cpu)
 
         yield from (v.format(**cpu) for k,v in core_builder_parts.items() if k in cpu)
         yield from (v.format(**cpu['DIB']) for k,v in dib_builder_parts.items() if k in cpu)
+        yield from (v.format(**cpu) for k,v in bb_builder_parts.items() if k in cpu['bytecode_buffer'])
+        local_bb_builder_parts = {
+            ('sectored', True): '  .set_bb_sectored()',
+            ('sectored', False): '  .reset_bb_sectored()',
+            ('predecode', True): '  .set_bb_predecode()',
+            ('predecode', False): '  .reset_bb_predecode()',
+            ('operand_hints', True): '  .set_bb_operand_hints()',
+            ('operand_hints', False): '  .reset_bb_operand_hints()',
+            ('early_restart', True): '  .set_bb_early_restart()',
+            ('early_restart', False): '  .reset_bb_early_restart()'
+        }
+        yield from (v for k,v in local_bb_builder_parts.items() if k[0] in cpu['bytecode_buffer'] and k[1] == cpu['bytecode_buffer'][k[0]])
+        if 'coherence' in cpu['bytecode_buffer']:
+            yield '  .bb_coherence(BB_COHERENCE::{})'.format(cpu['bytecode_buffer']['coherence'].upper())
+        if 'fill_level' in cpu['bytecode_buffer']:
+            yield '  .bb_fill_level(BB_FILL_LEVEL::{})'.format(cpu['bytecode_buffer']['fill_level'].upper())
+        yield from (v.format(**cpu) for k,v in hdbt_builder_parts.items() if k in cpu['bytecode_hdbt'])
+        if 'replacement' in cpu['bytecode_hdbt']:
+            yield '  .hdbt_replacement(HDBT_REPLACEMENT::{})'.format(cpu['bytecode_hdbt']['replacement'].upper())
+        yield from (v.format(**cpu) for k,v in dbtb_builder_parts.items() if k in cpu['bytecode_btb'])
+        if 'predictor' in cpu['bytecode_btb']:
+            yield '  .bytecode_target_predictor(BYTECODE_TARGET_PREDICTOR::{})'.format(cpu['bytecode_btb']['predictor'].upper())
+        yield from (v.format(**cpu) for k,v in ras_builder_parts.items() if k in cpu['bytecode_ras'])
+        if 'overflow' in cpu['bytecode_ras']:
+            yield '  .bytecode_ras_overflow(RAS_OVERFLOW::{})'.format(cpu['bytecode_ras']['overflow'].upper())
+        yield from (v.format(**cpu) for k,v in fusion_builder_parts.items() if k in cpu['bytecode_fusion'])
+        yield from (v.format(**cpu) for k,v in loop_builder_parts.items() if k in cpu['bytecode_loop'])
+        yield from (v.format(**cpu) for k,v in bytecode_l1_builder_parts.items() if k in cpu['bytecode_l1'])
+        if 'bytecode_context_switch' in cpu:
+            yield '  .bytecode_context_switch(BYTECODE_CONTEXT_SWITCH::{})'.format(cpu['bytecode_context_switch'].upper())
 
         if cpu.get('_branch_predictor_data'):
             yield '.branch_predictor<{}>()'.format(' | '.join('O3_CPU::b{}'.format(k['name']) for k in cpu['_branch_predictor_data']))
@@ -69,7 +69,7 @@ def normalize_config(config_file):
 
     # Default core elements
     # Give cores numeric indices
-    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB', 'bytecode_buffer', 'bytecode_hdbt', 'bytecode_btb', 'bytecode_ras', 'bytecode_fusion', 'bytecode_loop', 'bytecode_l1', 'bytecode_context_switch')
     cores = [util.chain(cpu, util.subdict(config_file, core_keys_to_copy), {'name': 'cpu'+str(i), '_index': i}) for i,cpu in enumerate(cores)]
 
     pinned_cache_names = ('L1I', 'L1D', 'ITLB', 'DTLB', 'L2C', 'STLB')
@@ -120,7 +120,7 @@ def parse_normalized(cores, caches, ptws, pmem, vmem, merged_configs, branch_con
     pmem = util.chain(pmem, default_pmem)
     vmem = util.chain(vmem, default_vmem)
 
-    cores = [util.chain(cpu, {'DIB': dict()}, default_core) for cpu in cores]
+    cores = [util.chain(cpu, {'DIB': dict(), 'bytecode_buffer': dict(), 'bytecode_hdbt': dict(), 'bytecode_btb': dict(), 'bytecode_ras': dict(), 'bytecode_fusion': dict(), 'bytecode_loop': dict(), 'bytecode_l1': dict()}, default_core) for cpu in cores]
 
     # Frequencies are the maximum of the upper levels, unless specified
     for cpu,name in itertools.product(cores, ('L1I', 'L1D', 'ITLB', 'DTLB')):
@@ -0,0 +1,116 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_BTB_H
+#define BYTECODE_BTB_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include <fmt/core.h>
+
+constexpr std::size_t BYTECODE_BTB_SIZE = 256;
+constexpr std::size_t DBTB_NUM_OPCODES = 256;
+constexpr std::size_t DBTB_ALIGNMENT = 64;
+constexpr std::size_t DBTB_JUMP_BITS = 16; // Jumps are stored as a signed bytecode offset
+constexpr std::size_t DBTB_OPARG_SETS = 0; // Sets of the (opcode, oparg) second level, 0 disables it
+constexpr std::size_t DBTB_OPARG_WAYS = 4;
+constexpr std::size_t DBTB_OPARG_BITS = 32; // Opargs with their EXTENDED_ARG prefixes
+
+struct btb_entry_stats {
+  uint64_t hit{0}, miss{0};
+};
+
+// The (opcode, oparg) second level, scored at every update against what the opcode-only first level predicted
+struct DBTB_OPARG_STATS {
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+  uint64_t allocations = 0;
+  uint64_t evictions = 0;
+  uint64_t opcode_only_correct = 0;
+  uint64_t correct = 0;
+};
+
+// Prediction state for one opcode, or one (opcode, oparg) pair in the second level
+struct DBTB_SUB_ENTRY {
+  int64_t jump = 0;
+  int32_t oparg = 0;
+  int8_t usage = 0;
+  int8_t confidence = 0;
+  bool valid = false;
+  bool allocated = false;
+
+  void update(int64_t correctJump, btb_entry_stats& entryCounters, btb_entry_stats& opcodeCounters);
+};
+
+// One entry per opcode and address space, sized to a single cache line
+struct alignas(DBTB_ALIGNMENT) DBTB_ENTRY {
+  DBTB_SUB_ENTRY outer;
+  uint64_t lru = 0; // Value of the table access counter at the last update
+  uint8_t asid = 0;
+  uint8_t opcode = 0;
+};
+static_assert(sizeof(DBTB_ENTRY) == DBTB_ALIGNMENT, "A DBTB entry should fit a single cache line");
+
+struct DBTB_OPARG_ENTRY {
+  DBTB_SUB_ENTRY sub;
+  int opcode = -1;
+  uint64_t lru = 0;
+  uint8_t asid = 0;
+};
+
+class BYTECODE_BTB {
+    // Directly indexed by opcode, hashed with the ASID so that address spaces sharing the table each have their
+    // own slot for an opcode. At most capacity entries are allocated at a time
+    std::array<DBTB_ENTRY, DBTB_NUM_OPCODES> table = {};
+    std::size_t capacity;
+    std::size_t allocated_entries = 0;
+    uint64_t access_counter = 0;
+    uint8_t current_asid = 0;
+
+    // Second level for opcodes whose jump depends on the oparg, set associative on a hash of both, LRU within a set
+    std::size_t oparg_sets, oparg_ways;
+    unsigned oparg_set_bits;
+    std::vector<DBTB_OPARG_ENTRY> oparg_table;
+
+    // Counters live next to the table, not in it, to keep the entries small
+    std::array<btb_entry_stats, DBTB_NUM_OPCODES> entry_counters = {};
+    std::array<btb_entry_stats, DBTB_NUM_OPCODES> opcode_counters = {};
+
+    // ASID 0 maps every opcode to its own slot, other ASIDs move them by an odd multiple of the ASID
+    std::size_t slot(int opcode) const { return (static_cast<std::size_t>(opcode) ^ (current_asid * 0x9Du)) % DBTB_NUM_OPCODES; }
+    static std::size_t opcodeIndex(int opcode) { return static_cast<std::size_t>(opcode) % DBTB_NUM_OPCODES; }
+    std::size_t opargSet(int opcode, int oparg) const;
+    DBTB_OPARG_ENTRY* findOpargEntry(int opcode, int oparg);
+    void updateOparg(const DBTB_ENTRY& entry, int opcode, int oparg, int64_t correct_jump);
+    bool foundVictim();
+
+ public:
+    DBTB_OPARG_STATS oparg_stats;
+    // Updates that took over the slot of another address space's entry
+    uint64_t slot_conflicts = 0;
+
+    BYTECODE_BTB() : BYTECODE_BTB(BYTECODE_BTB_SIZE, DBTB_OPARG_SETS, DBTB_OPARG_WAYS) {}
+    explicit BYTECODE_BTB(std::size_t entries) : BYTECODE_BTB(entries, DBTB_OPARG_SETS, DBTB_OPARG_WAYS) {}
+    BYTECODE_BTB(std::size_t entries, std::size_t oparg_sets_, std::size_t oparg_ways_);
+
+    std::size_t size() const { return capacity; }
+    bool opargsEnabled() const { return oparg_sets > 0; }
+    int64_t prediction(int opcode, int oparg);
+    // Jump and the confidence of the sub-entry behind it, opcodes without an entry are confidently sequential
+    std::pair<int64_t, int> predictionWithConfidence(int opcode, int oparg);
+    void update(int opcode, int oparg, int64_t correct_jump);
+    double print();
+    void generateStats(std::map<int, btb_entry_stats>& entryStats) const;
+    void resetStats();
+    uint64_t storageBits() const;
+    // Flushes the table, or keeps the entries of every address space, each in the slots its ASID hashes to.
+    // Returns the entries the new address space finds in the table
+    std::size_t contextSwitch(uint8_t asid, bool flush);
+};
+
+#endif
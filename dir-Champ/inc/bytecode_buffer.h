@@ -9,9 +9,11 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <fmt/core.h>
@@ -25,14 +27,29 @@
 #include <type_traits>
 
 constexpr std::size_t BYTECODE_SIZE = 2;
+// Default geometry, the sizes used at runtime come from the bytecode_buffer config block
 constexpr int BYTECODE_BUFFER_SIZE = 8;
 constexpr std::size_t BYTECODE_BUFFER_NUM = 6;
-constexpr int LOG2_BB_BUFFER_SIZE = champsim::lg2(BYTECODE_BUFFER_SIZE);
 constexpr uint64_t BYTECODE_FETCH_TIME = 1;
 constexpr uint64_t FETCH_OFFSET = 0; // 2 * BYTECODE_FETCH_TIME;
 constexpr uint64_t BYTECODE_BRANCH_MISPREDICT_PENALTY = 4;
 constexpr uint64_t BB_DEBUG_LEVEL = 0; // 0 = NONE, 1 = WARNINGS, 2 = HITS AND MISSES, 3 = INFO 
-constexpr int STARTING_LRU_VAL = 1 << 12;
+constexpr std::size_t BB_RUNAHEAD_DEPTH = 0; // Bytecodes the run-ahead prefetcher follows past the current one, 0 disables it
+constexpr int BB_RUNAHEAD_CONFIDENCE = 2; // Lowest DBTB confidence the run-ahead prefetcher follows
+constexpr int BB_DUAL_PATH_CONFIDENCE = 0; // Conditional bytecodes below this DBTB confidence fetch both successors, 0 disables it
+constexpr std::size_t BB_MAX_INDEXED_BUCKETS = 4; // two granules for the valid range, two for the fetching range
+constexpr bool BB_SECTORED = false; // Rows tagged per cache block, with a valid bit per row sized sector
+constexpr uint64_t BB_FILL_WIDTH = 0; // Bytecodes written into a row per cycle once its block returns, 0 writes the whole row at once
+constexpr bool BB_EARLY_RESTART = false; // Write the missed bytecode first and resume fetch on it, the rest of the row follows
+
+// What a store into a valid row does: nothing, drop the row (or its sector), or update the row in place
+enum class BB_COHERENCE { NONE, INVALIDATE, UPDATE };
+// Traces do not record store widths, a snooped store covers a word from its address, the widest store quickening makes
+constexpr uint64_t BB_STORE_BYTES = 8;
+
+// Cache the BB fetches rows from. L2C fetches look up the L1I on the way without filling it
+enum class BB_FILL_LEVEL { L1I, L1D, L2C };
+constexpr std::array<std::string_view, 3> bb_fill_level_names{"L1I", "L1D", "L2C"};
 
 struct BB_ENTRY_STATS {
     uint8_t index; 
@@ -54,10 +71,32 @@ struct BB_STATS {
     uint64_t hits = 0;
     uint64_t miss = 0;
     uint64_t totalMissWait = 0;
+    // Cycles the missed bytecodes would have waited for the slots in front of them, and the misses early restart moved up
+    uint64_t early_restart_saved = 0;
+    uint64_t early_restarts = 0;
     uint64_t prefetches = 0;
     uint64_t inflightMisses = 0;
     uint64_t duplicated_prefetches = 0;
     uint64_t aggressive_prefetches = 0;
+
+    // Run-ahead prefetcher, useful = timely + late
+    uint64_t runahead_prefetches = 0;
+    uint64_t runahead_useful = 0;
+    uint64_t runahead_timely = 0;
+    uint64_t runahead_late = 0;
+
+    // Second successor fetched for low confidence conditional bytecodes, and how often it was the one executed
+    uint64_t dual_path_fetches = 0;
+    uint64_t dual_path_used = 0;
+
+    // Stores into co_code that hit a valid row, and the misses on rows they invalidated. Rows fetching when a store
+    // hits them drop the stored sectors once their block returns, updated rows rewrite the stored slots
+    uint64_t quickening_writes = 0;
+    uint64_t coherence_invalidations = 0;
+    uint64_t coherence_misses = 0;
+    uint64_t coherence_inflight = 0;
+    uint64_t coherence_updates = 0;
+
     std::vector<BB_ENTRY_STATS> entryStats = {};
     double averageWaitTime() const { return (double) totalMissWait/ (double) miss; }
 };
@@ -70,6 +109,10 @@ struct BB_ENTRY {
     uint64_t hits_since_last_switch = 0;
     uint64_t switched_with_no_hits = 0;
     uint64_t prefetch = false;
+    bool runahead = false;
+    bool runahead_used = false;
+    bool invalidated_by_store = false;
+    uint8_t asid = 0; // Address space the row was filled for
 
     uint64_t baseAddr;
     uint64_t maxAddr; 
@@ -78,17 +121,56 @@ struct BB_ENTRY {
     uint64_t fetching_max_addr; 
     bool valid = false;
     bool fetching = false;
-    int lru = 0; 
+    uint64_t lru = 0; // Value of the buffer access counter at the last hit or fill
+
+    // Bit i covers the i-th row sized sector from baseAddr, unsectored rows keep every bit set
+    uint64_t valid_sectors = 0;
+    unsigned log2_sector_bytes = 0;
+    // Sectors of the fetching range a store hit while the block was in flight, the block brings their old contents
+    uint64_t stale_sectors = 0;
+
+    // Bit i covers the i-th bytecode from baseAddr, set once the returned block has been written into its slot.
+    // The slots are written from write_next on, wrapping around the row, until slots_to_write reaches 0
+    uint64_t written_slots = std::numeric_limits<uint64_t>::max();
+    uint64_t write_next = 0;
+    uint64_t slots_to_write = 0;
+
+    // Index buckets this row is currently registered in
+    std::array<std::size_t, BB_MAX_INDEXED_BUCKETS> indexed_buckets = {};
+    std::size_t num_indexed_buckets = 0;
 
-    bool hit(uint64_t sourceAddr) const { return ((sourceAddr >= baseAddr) && (sourceAddr <= maxAddr) && valid); }
-    bool currentlyFetching(uint64_t sourceAddr) const { return ((sourceAddr >= fetching_base_addr) && (sourceAddr <= fetching_max_addr) && fetching); }
-    void fetch(uint64_t sourceAddr, uint64_t currentCycle) {
+    uint64_t slot(uint64_t sourceAddr) const { return (sourceAddr - baseAddr) / BYTECODE_SIZE; }
+    uint64_t slots() const { return (maxAddr - baseAddr) / BYTECODE_SIZE + 1; }
+    bool holds(uint64_t sourceAddr) const
+    {
+        return ((sourceAddr >= baseAddr) && (sourceAddr <= maxAddr) && valid && ((valid_sectors >> ((sourceAddr - baseAddr) >> log2_sector_bytes)) & 1));
+    }
+    bool hit(uint64_t sourceAddr) const { return holds(sourceAddr) && ((written_slots >> slot(sourceAddr)) & 1); }
+    // The block has returned, but the slot of the address has not been written yet
+    bool writing(uint64_t sourceAddr) const { return slots_to_write > 0 && holds(sourceAddr) && !((written_slots >> slot(sourceAddr)) & 1); }
+    // Fetching, or its block has returned and is still being written
+    bool busy() const { return fetching || slots_to_write > 0; }
+    bool currentlyFetching(uint64_t sourceAddr) const
+    {
+        return ((sourceAddr >= fetching_base_addr) && (sourceAddr <= fetching_max_addr) && fetching) || writing(sourceAddr);
+    }
+    void fetch(uint64_t sourceAddr, uint64_t currentCycle, uint64_t rowSize) {
         fetching = true;
+        runahead = false;
+        runahead_used = false;
+        invalidated_by_store = false;
+        stale_sectors = 0;
         timesSwitchedOut++;
         fetching_base_addr = (sourceAddr & ~1) - (FETCH_OFFSET * BYTECODE_SIZE);
-        fetching_max_addr = (sourceAddr & ~1) + ((BYTECODE_BUFFER_SIZE - FETCH_OFFSET) * BYTECODE_SIZE);
+        fetching_max_addr = (sourceAddr & ~1) + ((rowSize - FETCH_OFFSET) * BYTECODE_SIZE);
         fetchingEventCycle = currentCycle;
     }
+    // A sectored row fetches the whole cache block around the address
+    void fetchBlock(uint64_t sourceAddr, uint64_t currentCycle) {
+        fetch(sourceAddr, currentCycle, 0);
+        fetching_base_addr = (sourceAddr >> LOG2_BLOCK_SIZE) << LOG2_BLOCK_SIZE;
+        fetching_max_addr = fetching_base_addr + BLOCK_SIZE - BYTECODE_SIZE;
+    }
 
     bool inCacheBlock(uint64_t blockBase) const {
         return fetching && (fetching_base_addr >> LOG2_BLOCK_SIZE) == (blockBase >> LOG2_BLOCK_SIZE);
@@ -103,15 +185,61 @@ struct BB_ENTRY {
 };
 
 class BYTECODE_BUFFER {
+    std::size_t rows;
+    uint64_t row_size;
+    unsigned log2_row_size;
+    unsigned log2_row_bytes;
+    bool sectored;
+    // Shift from an address to its index granule, fixed with the geometry so a lookup does not recompute it
+    unsigned granule_bits;
+    BB_COHERENCE coherence;
+    uint64_t fill_width;
+    bool early_restart;
+    uint8_t current_asid = 0;
+    // Set once a switch kept the rows of another address space, whose fills may still be in flight
+    bool foreign_rows = false;
+    std::size_t rows_writing = 0;
+
     std::vector<BB_ENTRY> buffers; 
+    uint64_t access_counter = 0;
+
+    // Address range index: rows are registered in the buckets of every granule (row sized, or block
+    // sized for sectored rows, aligned chunk of bytecode memory) their valid or fetching range
+    // touches, so a lookup only checks the rows in a single bucket
+    std::vector<std::vector<std::size_t>> index;
+    std::vector<std::size_t> scratch;
+
+    std::size_t bucket(uint64_t addr) const { return (addr >> granule_bits) & (std::size(index) - 1); }
+    void unindex(BB_ENTRY& entry);
+    void reindex(BB_ENTRY& entry);
+    void rowsInBlock(uint64_t blockBase);
+    void startFetch(BB_ENTRY& entry, uint64_t baseAddr, uint64_t currentCycle);
+    void validate(BB_ENTRY& entry, uint64_t currentCycle);
+    void writeSlots(BB_ENTRY& entry);
+    void stopWriting(BB_ENTRY& entry);
+    void rewriteSlots(BB_ENTRY& entry, uint64_t first, uint64_t last);
+    void invalidate(BB_ENTRY& entry, uint64_t sectors);
+    void recordMissWait(const BB_ENTRY& entry, uint64_t currentCycle);
 
-    void decrementLRUs();
     BB_ENTRY* hit(uint64_t sourceMemoryAddr);
     BB_ENTRY* find_victim(bool prefetch);
+    BB_ENTRY* find_protected_victim(const std::vector<uint64_t>& protectedAddrs);
 
  public:
     BB_STATS stats;
     std::pair<bool, uint64_t> currFetching;
+    const std::size_t runahead_depth;
+    const int runahead_confidence;
+    const int dual_path_confidence;
+
+    BYTECODE_BUFFER() : BYTECODE_BUFFER(BYTECODE_BUFFER_NUM, BYTECODE_BUFFER_SIZE, BB_RUNAHEAD_DEPTH, BB_RUNAHEAD_CONFIDENCE, BB_DUAL_PATH_CONFIDENCE, BB_SECTORED, BB_COHERENCE::NONE,
+                                          BB_FILL_WIDTH, BB_EARLY_RESTART) {}
+    BYTECODE_BUFFER(std::size_t num_rows, uint64_t bytecodes_per_row, std::size_t runahead_depth_, int runahead_confidence_, int dual_path_confidence_,
+                    bool sectored_rows, BB_COHERENCE coherence_policy, uint64_t fill_width_, bool early_restart_);
+
+    uint64_t rowSize() const { return row_size; }
+    unsigned log2RowSize() const { return log2_row_size; }
+    uint64_t storageBits() const;
 
     void printInterestingThings();
     void initialize();
@@ -121,8 +249,24 @@ class BYTECODE_BUFFER {
     bool hitInBB(uint64_t sourceMemoryAddr);
     bool shouldFetch(uint64_t sourceMemoryAddr);
     bool updateBufferEntries(uint64_t baseAddr, uint64_t currentCycle);
+    // Writes the next fill_width slots of the rows whose block has returned, true when the demand miss can now resume
+    bool writeRows(uint64_t currentCycle);
     bool currentlyFetching(uint64_t baseAddr);
     bool blockIsNeeded(uint64_t blockBase);
+    bool inBuffer(uint64_t baseAddr);
+    bool inBufferOrFetching(uint64_t baseAddr);
+    // Flushes the rows and drops the fills in flight, or keeps the rows and fills of the previous address space
+    // tagged but out of reach of lookups, its fills still validate their rows when they return. Returns the valid
+    // rows the new address space finds in the buffer
+    std::size_t contextSwitch(uint8_t asid, bool flush);
+    // Applies the coherence policy to every bytecode a store covers, true when it hit a valid or fetching row
+    bool snoopStore(uint64_t storeAddr, uint64_t storeBytes);
+
+    // Run-ahead and dual path fills only take rows that are not fetching and do not hold any of the protected
+    // addresses, so they neither cancel another fill nor evict the rows the predicted path needs
+    bool protectedVictimAvailable(const std::vector<uint64_t>& protectedAddrs);
+    void runaheadFetching(uint64_t baseAddr, uint64_t currentCycle, const std::vector<uint64_t>& protectedAddrs);
+    void dualPathFetching(uint64_t baseAddr, uint64_t currentCycle, const std::vector<uint64_t>& protectedAddrs);
 };
 
 #endif
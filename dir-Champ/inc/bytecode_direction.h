@@ -0,0 +1,61 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_DIRECTION_H
+#define BYTECODE_DIRECTION_H
+
+#include <cstdint>
+#include <vector>
+
+// Default gshare geometry, 0 entries leaves conditional bytecodes to the target predictor alone
+constexpr std::size_t DIRECTION_ENTRIES = 0;
+constexpr std::size_t DIRECTION_HISTORY = 8;
+constexpr std::size_t DIRECTION_CTR_BITS = 2;
+
+struct DIRECTION_STATS {
+    uint64_t predictions = 0;
+    uint64_t correct = 0;
+    uint64_t taken = 0;
+    uint64_t predicted_taken = 0;
+};
+
+// gshare over the BPCs of conditional bytecodes, it only picks the direction, the taken target
+// stays in the DBTB, which is only trained on taken outcomes so fall-throughs do not reset it
+class BYTECODE_DIRECTION {
+    std::size_t entries;
+    std::size_t history_length;
+    unsigned index_bits;
+
+    std::vector<uint8_t> counters;
+    uint64_t history = 0;
+
+    // Lookup state kept from the last prediction, used by the update that follows it
+    std::size_t last_index = 0;
+    bool last_taken = false;
+
+    std::size_t index(uint64_t bpc) const;
+
+ public:
+    DIRECTION_STATS stats;
+
+    BYTECODE_DIRECTION() : BYTECODE_DIRECTION(DIRECTION_ENTRIES, DIRECTION_HISTORY) {}
+    BYTECODE_DIRECTION(std::size_t num_entries, std::size_t history_bits);
+
+    bool enabled() const { return entries > 0; }
+    // POP_JUMP_*, JUMP_IF_*_OR_POP, COMPARE_OP_*_JUMP and FOR_ITER
+    static bool isConditional(int opcode);
+    // Jump to the next bytecode when a conditional bytecode is not taken
+    static int64_t fallThrough(int opcode);
+
+    bool predict(uint64_t bpc);
+    // Prediction without keeping lookup state, for bytecodes further down the predicted path
+    bool peek(uint64_t bpc) const;
+    // Trains the counter of the last prediction, every update follows the prediction for the same BPC
+    void update(bool taken);
+    uint64_t storageBits() const;
+    void resetStats();
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_FUSION_H
+#define BYTECODE_FUSION_H
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Default pair table size, 0 disables fusion
+constexpr std::size_t FUSION_ENTRIES = 0;
+constexpr unsigned FUSION_COUNTER_BITS = 4;
+constexpr unsigned FUSION_THRESHOLD = 8; // Counter value from which a pair is fused
+constexpr uint64_t FUSION_DECAY_PERIOD = 4096; // Pair observations between halving every counter
+
+struct FUSION_PAIR_STATS {
+    int first;
+    int second;
+    uint64_t fused = 0;
+    uint64_t instructions_saved = 0;
+    uint64_t cycles_saved = 0;
+};
+
+struct FUSION_STATS {
+    uint64_t observed_pairs = 0;
+    uint64_t allocations = 0;
+    uint64_t fused = 0;
+    uint64_t instructions_saved = 0;
+    uint64_t cycles_saved = 0;
+    std::vector<FUSION_PAIR_STATS> pairStats = {};
+};
+
+struct FUSION_ENTRY {
+    int first = -1;
+    int second = -1;
+    unsigned counter = 0;
+    bool valid = false;
+};
+
+// Per pair counters, kept outside the table so they survive evictions
+struct FUSION_PAIR_COUNTERS {
+    uint64_t fused = 0;
+    uint64_t instructions_saved = 0;
+    uint64_t cycles_saved = 0;
+};
+
+class BYTECODE_FUSION {
+    std::size_t entries;
+    unsigned threshold;
+
+    // Fully associative, the entry with the lowest counter is replaced
+    std::vector<FUSION_ENTRY> table;
+    std::map<std::pair<int, int>, FUSION_PAIR_COUNTERS> counters;
+    uint64_t observations = 0;
+
+    // Last bytecode whose dispatch the core skips, a pair is two of them at consecutive BPCs
+    bool last_valid = false;
+    bool last_fused = false;
+    uint64_t last_bpc = 0;
+    int last_opcode = 0;
+    std::pair<int, int> fused_pair = {-1, -1};
+
+    FUSION_ENTRY* find(int first, int second);
+    void train(int first, int second);
+
+ public:
+    FUSION_STATS stats;
+
+    BYTECODE_FUSION() : BYTECODE_FUSION(FUSION_ENTRIES, FUSION_THRESHOLD) {}
+    BYTECODE_FUSION(std::size_t num_entries, unsigned fuse_threshold);
+
+    bool enabled() const { return entries > 0; }
+    // Called for every bytecode, skippable when the core skips its dispatch. True when the bytecode closes a
+    // hot pair with the previous one, which then runs it from a fused handler without a dispatch of its own
+    bool dispatch(uint64_t bpc, int opcode, bool skippable);
+    // Charge what the last fused dispatch saved over an unfused core to its pair
+    void recordSavings(uint64_t instructions, uint64_t cycles);
+    void generateStats();
+    void resetStats();
+    uint64_t storageBits() const;
+};
+
+#endif
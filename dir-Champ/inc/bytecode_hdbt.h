@@ -7,28 +7,24 @@
 #define BYTECODE_HDBT_H
 
 #include <array>
-#include <bitset>
-#include <deque>
-#include <memory>
-#include <stdexcept>
-#include <string>
+#include <cstdint>
 #include <vector>
-#include <map>
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
-#include "champsim.h"
-#include "champsim_constants.h"
-#include "channel.h"
-#include "cache.h"
-#include "operable.h"
-#include <type_traits>
+#include "util/bits.h"
 
-constexpr std::size_t HDBT_SIZE = 256;
-constexpr int STARTING_HDBT_LRU_VAL = 1 << 12;
+// Default geometry, the sizes used at runtime come from the bytecode_hdbt config block
+constexpr std::size_t HDBT_SETS = 64;
+constexpr std::size_t HDBT_WAYS = 4;
+constexpr std::size_t HDBT_SIZE = HDBT_SETS * HDBT_WAYS;
+constexpr std::size_t HDBT_NUM_OPCODES = 256;
+constexpr std::size_t HDBT_PREFETCH_DEPTH = 0; // L1I lines prefetched from the start of the next handler, 0 disables it
+
+enum class HDBT_REPLACEMENT { LRU, FIFO, RANDOM };
 
 struct HDBT_ENTRY_STATS {
-    int opcode; 
+    int opcode;
     uint64_t timesSwitchedOut = 0;
     uint64_t hits = 0;
     uint64_t miss = 0;
@@ -44,36 +40,79 @@ struct HDBT_ENTRY_STATS {
 struct HDBT_STATS {
     uint64_t hits = 0;
     uint64_t miss = 0;
+
+    // Handler prefetcher, coverage = covered / handler_dispatches
+    uint64_t handler_prefetches = 0;
+    uint64_t handler_dispatches = 0;
+    uint64_t covered = 0;
+    uint64_t late = 0;
+
     std::vector<HDBT_ENTRY_STATS> entryStats = {};
 };
 
+// Tag fields first, so an entry packs into 32 bytes and a 4-way set into two cache lines
 struct HDBT_ENTRY {
-    int opcode; 
+    int opcode = -1;
+    bool valid = false;
+    uint64_t handler = 0; // Entry point of the opcode's handler, 0 until it has been dispatched to
+
+    // Timestamps taken from the table access counter, no per access sweeps needed
+    uint64_t last_used = 0;
+    uint64_t inserted = 0;
+};
+static_assert(sizeof(HDBT_ENTRY) == 32, "Four HDBT ways should fill two cache lines");
+
+// Per opcode counters, kept outside the table so they survive evictions
+struct HDBT_OPCODE_COUNTERS {
+    bool seen = false;
     uint64_t timesSwitchedOut = 0;
     uint64_t hits = 0;
-    uint64_t miss = 1;
-
-    bool valid = false;
-    int lru = STARTING_HDBT_LRU_VAL; 
-    
-    HDBT_ENTRY(int code) { 
-        opcode=code; 
-        valid = true;
-    }
+    uint64_t miss = 0;
 };
 
 class BYTECODE_HDBT {
-    std::vector<HDBT_ENTRY> table; 
+    std::size_t sets, ways;
+    unsigned set_bits;
+    HDBT_REPLACEMENT replacement;
+
+    // sets * ways entries, stored set major
+    std::vector<HDBT_ENTRY> table;
+    std::array<HDBT_OPCODE_COUNTERS, HDBT_NUM_OPCODES> counters = {};
+    uint64_t access_counter = 0;
+    uint64_t rng_state = 0x2545F4914F6CDD1D;
+    // Handler the last prefetch was for, until the next dispatch checks it
+    uint64_t prefetched_handler = 0;
 
-    void decrementLRUs();
-    HDBT_ENTRY* find_victim();
+    std::size_t set_index(int opcode) const;
+    HDBT_ENTRY* find(int opcode);
+    const HDBT_ENTRY* find(int opcode) const;
+    HDBT_ENTRY* find_victim(std::size_t set);
 
  public:
     HDBT_STATS stats;
+    const std::size_t prefetch_depth;
+
+    BYTECODE_HDBT() : BYTECODE_HDBT(HDBT_SETS, HDBT_WAYS, HDBT_REPLACEMENT::LRU, HDBT_PREFETCH_DEPTH) {}
+    BYTECODE_HDBT(std::size_t num_sets, std::size_t num_ways, HDBT_REPLACEMENT repl, std::size_t prefetch_depth_);
+
+    std::size_t size() const { return sets * ways; }
+    uint64_t storageBits() const;
     void initialize();
     void generateStats();
     void resetStats();
     bool hit(int opcode);
+    // Lookup that neither fills nor counts, for asking what a lookup would have returned
+    bool contains(int opcode) const;
+
+    // Handler entry point of a resident opcode, 0 when it is not in the table or has no handler yet
+    uint64_t handler(int opcode) const;
+    void learnHandler(int opcode, uint64_t handler_addr);
+    void prefetchedHandler(uint64_t handler_addr);
+    // Counts a dispatch to handler_addr, true when the last prefetch was for it
+    bool coveredDispatch(uint64_t handler_addr);
+    // Flushes the table, or keeps it as it is, the traces are threads of one process and share their handlers.
+    // Returns the entries the new address space finds in the table
+    std::size_t contextSwitch(bool flush);
 };
 
 
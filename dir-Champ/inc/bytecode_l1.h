@@ -0,0 +1,72 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_L1_H
+#define BYTECODE_L1_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Default geometry, 0 bytes sends every BB fetch to the L1I
+constexpr std::size_t BYTECODE_L1_SIZE = 0;
+constexpr std::size_t BYTECODE_L1_WAYS = 4;
+constexpr uint64_t BYTECODE_L1_LATENCY = 2;
+constexpr std::size_t BYTECODE_L1_MSHR_SIZE = 4;
+
+struct BYTECODE_L1_STATS {
+    uint64_t hits = 0;
+    uint64_t miss = 0;
+    uint64_t merged = 0;    // Misses to a block that was already being fetched
+    uint64_t mshr_full = 0; // Misses sent to the L1I without allocating, they do not fill the bytecode L1
+    uint64_t fills = 0;
+    uint64_t totalFillWait = 0;
+};
+
+struct BYTECODE_L1_BLOCK {
+    uint64_t address = 0;
+    uint64_t lru = 0;
+    bool valid = false;
+};
+
+struct BYTECODE_L1_MSHR {
+    uint64_t address;
+    uint64_t cycle_enqueued;
+};
+
+// Set-associative cache of co_code blocks between the BB and the L1I, so that bytecode does not
+// compete with handler code in the L1I. Blocks are looked up by virtual address, like the BB.
+class BYTECODE_L1 {
+    std::size_t sets, ways, mshr_size;
+    uint64_t latency;
+
+    std::vector<BYTECODE_L1_BLOCK> blocks;
+    std::vector<BYTECODE_L1_MSHR> mshr;
+    // Hits waiting out the latency, in the order they complete
+    std::deque<std::pair<uint64_t, uint64_t>> hits_in_flight; // (ready cycle, address)
+    uint64_t access_counter = 0;
+
+    std::size_t set_index(uint64_t address) const;
+
+ public:
+    BYTECODE_L1_STATS stats;
+
+    BYTECODE_L1() : BYTECODE_L1(BYTECODE_L1_SIZE, BYTECODE_L1_WAYS, BYTECODE_L1_LATENCY, BYTECODE_L1_MSHR_SIZE) {}
+    BYTECODE_L1(std::size_t size_bytes, std::size_t num_ways, uint64_t hit_latency, std::size_t num_mshrs);
+
+    bool enabled() const { return sets > 0; }
+    // True when the block is served from here, either after the hit latency or by a fetch already in flight
+    bool access(uint64_t address, uint64_t cycle);
+    // A miss went out to the L1I, track it so that the block fills this cache when it returns
+    void allocate(uint64_t address, uint64_t cycle);
+    // L1I returned a block, only blocks this cache missed on are filled
+    void fill(uint64_t address, uint64_t cycle);
+    // Pops a hit whose latency has passed, 0 when there is none
+    uint64_t nextHit(uint64_t cycle);
+    uint64_t storageBits() const;
+    void resetStats();
+};
+
+#endif
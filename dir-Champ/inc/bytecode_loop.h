@@ -0,0 +1,73 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_LOOP_H
+#define BYTECODE_LOOP_H
+
+#include <cstdint>
+#include <vector>
+
+// Default geometry, 0 entries leaves loop branches to the direction and target predictors
+constexpr std::size_t LOOP_ENTRIES = 0;
+constexpr std::size_t LOOP_PREFETCH_DISTANCE = 2; // Iterations before the exit its row is prefetched, 0 disables it
+constexpr unsigned LOOP_TRIP_BITS = 10;
+constexpr int LOOP_MAX_CONFIDENCE = 3;
+constexpr int LOOP_CONFIDENT = 2; // Repeats of the same trip count before the loop predictor overrides
+
+struct LOOP_STATS {
+    uint64_t overrides = 0;
+    uint64_t correct = 0;
+    uint64_t exit_overrides = 0;
+    uint64_t exit_correct = 0;
+    uint64_t exit_prefetches = 0;
+    uint64_t allocations = 0;
+};
+
+// A loop is identified by the BPC of the bytecode that leaves it, FOR_ITER or a backward conditional jump
+struct LOOP_ENTRY {
+    uint64_t bpc = 0;
+    int64_t taken_jump = 0;
+    uint16_t trip = 0;    // Iterations between the last two exits
+    uint16_t current = 0; // Iterations since the last exit
+    int8_t confidence = 0;
+    bool valid = false;
+    uint64_t lru = 0;
+};
+
+class BYTECODE_LOOP {
+    // Fully associative, least recently used entry is replaced
+    std::vector<LOOP_ENTRY> table;
+    uint64_t access_counter = 0;
+
+    // Override made by the last prediction, checked by the update that follows it
+    int64_t last_override = 0;
+    bool last_exit = false;
+
+    LOOP_ENTRY* find(uint64_t bpc);
+    const LOOP_ENTRY* find(uint64_t bpc) const;
+
+ public:
+    LOOP_STATS stats;
+    const std::size_t prefetch_distance;
+
+    BYTECODE_LOOP() : BYTECODE_LOOP(LOOP_ENTRIES, LOOP_PREFETCH_DISTANCE) {}
+    BYTECODE_LOOP(std::size_t num_entries, std::size_t prefetch_distance_);
+
+    bool enabled() const { return !table.empty(); }
+    // FOR_ITER and POP_JUMP_BACKWARD_IF_*, unconditional backward jumps never leave a loop
+    static bool isLoopBranch(int opcode);
+    // FOR_ITER leaves its loop by jumping, the backward jumps by falling through
+    static bool exitIsTaken(int opcode);
+
+    // Jump of a confident loop, 0 when the prediction is left to the other predictors
+    int64_t predict(uint64_t bpc, int opcode);
+    void update(uint64_t bpc, int opcode, int64_t correct_jump);
+    // Exit BPC of a confident loop that is prefetch_distance iterations from its exit, 0 otherwise
+    uint64_t exitPrefetch(uint64_t bpc, int opcode) const;
+    uint64_t storageBits() const;
+    void resetStats();
+};
+
+#endif
@@ -7,27 +7,60 @@
 #define BYTECODE_MODULE_H
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <tuple>
 #include <map>
 
 #include "cache.h"
 #include "champsim.h"
 #include "deadlock.h"
 #include "instruction.h"
+#include "bytecode_btb.h"
 #include "bytecode_buffer.h"
+#include "bytecode_direction.h"
+#include "bytecode_fusion.h"
 #include "bytecode_hdbt.h"
+#include "bytecode_l1.h"
+#include "bytecode_loop.h"
+#include "bytecode_ras.h"
+#include "bytecode_tage.h"
 #include "util/span.h"
 #include <fmt/chrono.h>
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
-constexpr std::size_t BYTECODE_BTB_SIZE = 256;
-constexpr int STARTING_BBTB_LRU_VAL = 1 << 12;
+constexpr std::size_t RUNAHEAD_DECODE_SIZE = 1024;
 
-struct btb_entry_stats {
-  uint64_t hit{0}, miss{0};
+// What a change of ASID does to the BB, HDBT and DBTB: nothing, flush them, or give each ASID its own BB rows and
+// DBTB entries. The traces are threads of one process, so under PARTITION the HDBT's handlers stay shared
+enum class BYTECODE_CONTEXT_SWITCH { NONE, FLUSH, PARTITION };
+
+// Opcode and oparg last seen at a BPC. The BB rows hold no bytecode contents, this stands in for decoding them out of a
+// resident row, so it is only read for BPCs the BB holds
+struct RUNAHEAD_DECODE_ENTRY {
+    uint64_t bpc = 0;
+    int opcode = 0;
+    int oparg = 0;
+    bool valid = false;
+};
+
+// valid, the BPC bits the index does not give back, and the code unit, an opcode byte and an oparg byte
+constexpr uint64_t RUNAHEAD_DECODE_ENTRY_BITS = 1 + (64 - champsim::lg2(BYTECODE_SIZE) - champsim::lg2(RUNAHEAD_DECODE_SIZE)) + 8 * BYTECODE_SIZE;
+
+// Bits of state each bytecode structure holds, with its tags, targets, confidence and replacement state
+struct BYTECODE_STORAGE {
+    uint64_t bb = 0;
+    uint64_t hdbt = 0;
+    uint64_t target_predictor = 0;
+    uint64_t ras = 0;
+    uint64_t fusion = 0;
+    uint64_t l1 = 0;
+    uint64_t decode = 0;
+
+    uint64_t total() const { return bb + hdbt + target_predictor + ras + fusion + l1 + decode; }
 };
 
 struct BYTCODE_MODULE_STATS {
@@ -40,7 +73,34 @@ struct BYTCODE_MODULE_STATS {
     uint64_t small_jumps = 0;
 
     std::map<int, btb_entry_stats> dbtb_entryStats = {};
+    DBTB_OPARG_STATS dbtb_oparg_stats = {};
+    // Stores that hit the BB, by the opcode they overwrote, CACHE for inline cache entries
+    std::map<int, uint64_t> quickening_writes = {};
+
+    // Pre-decode without skipping: dispatch jump targets installed in the BTB and those the jump took, and why others were not installed
+    uint64_t predecode_installs = 0;
+    uint64_t predecode_useful = 0;
+    uint64_t predecode_not_buffered = 0;
+    uint64_t predecode_no_handler = 0;
+
+    // ASID changes seen at bytecode loads, and the entries the incoming context found in each structure
+    uint64_t context_switches = 0;
+    uint64_t switch_bb_rows = 0;
+    uint64_t switch_hdbt_entries = 0;
+    uint64_t switch_dbtb_entries = 0;
+    // DBTB updates that took over a slot another ASID's entry held
+    uint64_t dbtb_slot_conflicts = 0;
     double BTB_PERCENTAGE = 0;
+
+    BYTECODE_TARGET_PREDICTOR target_predictor = BYTECODE_TARGET_PREDICTOR::DBTB;
+    uint64_t target_predictor_storage_bits = 0;
+    BYTECODE_STORAGE storage = {};
+    TAGE_STATS tage_stats = {};
+    DIRECTION_STATS direction_stats = {};
+    LOOP_STATS loop_stats = {};
+    RAS_STATS ras_stats = {};
+    FUSION_STATS fusion_stats = {};
+    BYTECODE_L1_STATS l1_stats = {};
 };
 
 class BYTECODE_MODULE {
@@ -50,10 +110,37 @@ class BYTECODE_MODULE {
     int last_branch_oparg; 
 
     uint64_t last_bpc, last_prediction;
+    // Return BPC pushed by the last bytecode if it was a call, and the BPC the RAS predicted for the last return
+    uint64_t pending_call_return = 0, last_ras_prediction = 0;
+    // Successor fetched next to the predicted one, checked against the bytecode that follows
+    uint64_t pending_dual_path = 0;
+
+    BYTECODE_TARGET_PREDICTOR target_predictor = BYTECODE_TARGET_PREDICTOR::DBTB;
+    BYTECODE_CONTEXT_SWITCH context_switch = BYTECODE_CONTEXT_SWITCH::NONE;
+    uint8_t current_asid = 0;
+    bool seen_context = false;
+    // The prediction made for the last bytecode of the previous context is not checked against the next one
+    bool switched_context = false;
+    // Dispatch mode and CPU options the structures are used under, storage() charges only what they use
+    champsim::dispatch_mode dispatch = champsim::dispatch_mode::SKIP;
+    bool predecode_enabled = false, operand_hints_enabled = false;
+    BYTECODE_BTB dbtb;
+    BYTECODE_TAGE tage;
+    BYTECODE_DIRECTION direction;
+    BYTECODE_LOOP loop;
+    std::array<RUNAHEAD_DECODE_ENTRY, RUNAHEAD_DECODE_SIZE> decode_table = {};
+
+    // Pre-decode state, the dispatch jump ending each opcode's handler and the handler each opcode
+    // dispatched to, which is what the interpreter's dispatch table holds
+    std::array<std::pair<uint64_t, uint8_t>, HDBT_NUM_OPCODES> dispatch_jump = {};
+    std::array<uint64_t, HDBT_NUM_OPCODES> dispatch_table = {};
+    int predecode_running = -1, predecode_loaded = -1;
+    bool predecode_predicted = false;
+    std::pair<uint64_t, uint64_t> predecode_installed = {0, 0};
 
     bool make_btb_prediction(int opcode, int oparg);
-    int64_t btb_prediction(int opcode, int oparg);
-    void update_btb(int opcode, int oparg, int64_t correct_jump);
+    int64_t btb_prediction(int opcode, int oparg, uint64_t bpc);
+    void update_btb(int opcode, int oparg, uint64_t bpc, int64_t correct_jump);
     void generateDBTBStats();
     void resetDBTBStats();
     
@@ -61,13 +148,63 @@ class BYTECODE_MODULE {
         BYTECODE_BUFFER bb_buffer;
         BYTCODE_MODULE_STATS stats;
         BYTECODE_HDBT hdbt;
+        BYTECODE_RAS ras;
+        BYTECODE_FUSION fusion;
+        BYTECODE_L1 bytecode_l1;
+
+        BYTECODE_MODULE() = default;
+        BYTECODE_MODULE(BYTECODE_BUFFER bb_buffer_, BYTECODE_HDBT hdbt_, BYTECODE_BTB dbtb_, BYTECODE_TARGET_PREDICTOR target_predictor_, BYTECODE_RAS ras_,
+                        BYTECODE_FUSION fusion_, BYTECODE_DIRECTION direction_, BYTECODE_LOOP loop_, BYTECODE_L1 bytecode_l1_,
+                        BYTECODE_CONTEXT_SWITCH context_switch_)
+            : target_predictor(target_predictor_), context_switch(context_switch_), dbtb(std::move(dbtb_)), direction(std::move(direction_)), loop(std::move(loop_)), bb_buffer(std::move(bb_buffer_)), hdbt(std::move(hdbt_)), ras(std::move(ras_)),
+              fusion(std::move(fusion_)), bytecode_l1(std::move(bytecode_l1_)) {}
+
         void printBTBs();
+        // Bits of prediction state held by the selected target predictor, including its DBTB base, the direction and loop predictors
+        uint64_t targetPredictorStorageBits() const;
+        // Bits held by the structures the dispatch mode and options use, zero for the others
+        BYTECODE_STORAGE storage() const;
         void generateStats();
         void resetStats();
 
         void initialize(uint32_t cpu);
+        void setDispatch(champsim::dispatch_mode mode, bool predecode_, bool operand_hints_)
+        {
+            dispatch = mode;
+            predecode_enabled = predecode_;
+            operand_hints_enabled = operand_hints_;
+        }
         uint64_t predict_branching(int opcode, int oparg,  uint64_t current_bpc);
         bool correctPrediction(uint64_t correct_target);
+
+        void recordBytecode(uint64_t bpc, int opcode, int oparg);
+        // Called with the ASID of every bytecode load, applies the context switch policy when it changes
+        void switchContext(uint8_t asid);
+        // Store snooped against the BB, quickening rewrites co_code in place
+        void snoopStore(uint64_t storeAddr, uint64_t storeBytes);
+        // Next BPC on the predicted path, 0 when the run-ahead should stop: the bytecode at bpc is not in the BB or
+        // its target is not confident
+        uint64_t runaheadNext(uint64_t bpc, int min_confidence);
+        // Opcode of the bytecode at a BPC the BB holds, -1 when it is not in the BB
+        int bufferedOpcode(uint64_t bpc) { return bufferedBytecode(bpc).first; }
+        // Opcode and oparg of the bytecode at a BPC the BB holds, an opcode of -1 when it is not in the BB
+        std::pair<int, int> bufferedBytecode(uint64_t bpc);
+        // BB row to prefetch for the exit of the loop the bytecode closes, 0 when it is not due yet
+        uint64_t loopExitPrefetch(uint64_t bpc, int opcode) const { return loop.exitPrefetch(bpc, opcode); }
+        void loopExitPrefetched() { loop.stats.exit_prefetches++; }
+        // Successor of a conditional bytecode on the path not predicted, when the target predictor is below the dual path confidence, 0 otherwise
+        uint64_t dualPathTarget(uint64_t bpc, int opcode, int oparg, uint64_t predicted_next_bpc);
+        // At a bytecode load without skipping: trains the target predictor and pre-decodes the predicted next
+        // bytecode from the BB. Returns the dispatch jump ending this bytecode's handler, its branch type and the
+        // handler it will jump to, a zero jump when the next bytecode or its handler is not known
+        std::tuple<uint64_t, uint8_t, uint64_t> predecode(uint64_t bpc, int opcode, int oparg);
+        // A dispatch jump executed without skipping
+        void learnDispatch(uint64_t jump_ip, uint8_t branch_type, uint64_t handler);
+        void dualPathFetched(uint64_t alternate_bpc)
+        {
+            pending_dual_path = alternate_bpc;
+            bb_buffer.stats.dual_path_fetches++;
+        }
 };
 
 
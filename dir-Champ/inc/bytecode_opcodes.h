@@ -0,0 +1,263 @@
+// Generated by tools/generate_bytecode_opcodes.py from Cpython-dir/Include/opcode.h, do not edit
+
+#ifndef BYTECODE_OPCODES_H
+#define BYTECODE_OPCODES_H
+
+#include <array>
+#include <string_view>
+
+namespace bytecode_opcode
+{
+constexpr int CACHE                                        = 0;
+constexpr int POP_TOP                                      = 1;
+constexpr int PUSH_NULL                                    = 2;
+constexpr int BINARY_OP_ADAPTIVE                           = 3;
+constexpr int BINARY_OP_ADD_FLOAT                          = 4;
+constexpr int BINARY_OP_ADD_INT                            = 5;
+constexpr int BINARY_OP_ADD_UNICODE                        = 6;
+constexpr int BINARY_OP_INPLACE_ADD_UNICODE                = 7;
+constexpr int BINARY_OP_MULTIPLY_FLOAT                     = 8;
+constexpr int NOP                                          = 9;
+constexpr int UNARY_POSITIVE                               = 10;
+constexpr int UNARY_NEGATIVE                               = 11;
+constexpr int UNARY_NOT                                    = 12;
+constexpr int BINARY_OP_MULTIPLY_INT                       = 13;
+constexpr int BINARY_OP_SUBTRACT_FLOAT                     = 14;
+constexpr int UNARY_INVERT                                 = 15;
+constexpr int BINARY_OP_SUBTRACT_INT                       = 16;
+constexpr int BINARY_SUBSCR_ADAPTIVE                       = 17;
+constexpr int BINARY_SUBSCR_DICT                           = 18;
+constexpr int BINARY_SUBSCR_GETITEM                        = 19;
+constexpr int BINARY_SUBSCR_LIST_INT                       = 20;
+constexpr int BINARY_SUBSCR_TUPLE_INT                      = 21;
+constexpr int CALL_ADAPTIVE                                = 22;
+constexpr int CALL_PY_EXACT_ARGS                           = 23;
+constexpr int CALL_PY_WITH_DEFAULTS                        = 24;
+constexpr int BINARY_SUBSCR                                = 25;
+constexpr int COMPARE_OP_ADAPTIVE                          = 26;
+constexpr int COMPARE_OP_FLOAT_JUMP                        = 27;
+constexpr int COMPARE_OP_INT_JUMP                          = 28;
+constexpr int COMPARE_OP_STR_JUMP                          = 29;
+constexpr int GET_LEN                                      = 30;
+constexpr int MATCH_MAPPING                                = 31;
+constexpr int MATCH_SEQUENCE                               = 32;
+constexpr int MATCH_KEYS                                   = 33;
+constexpr int EXTENDED_ARG_QUICK                           = 34;
+constexpr int PUSH_EXC_INFO                                = 35;
+constexpr int CHECK_EXC_MATCH                              = 36;
+constexpr int CHECK_EG_MATCH                               = 37;
+constexpr int JUMP_BACKWARD_QUICK                          = 38;
+constexpr int LOAD_ATTR_ADAPTIVE                           = 39;
+constexpr int LOAD_ATTR_INSTANCE_VALUE                     = 40;
+constexpr int LOAD_ATTR_MODULE                             = 41;
+constexpr int LOAD_ATTR_SLOT                               = 42;
+constexpr int LOAD_ATTR_WITH_HINT                          = 43;
+constexpr int LOAD_CONST__LOAD_FAST                        = 44;
+constexpr int LOAD_FAST__LOAD_CONST                        = 45;
+constexpr int LOAD_FAST__LOAD_FAST                         = 46;
+constexpr int LOAD_GLOBAL_ADAPTIVE                         = 47;
+constexpr int LOAD_GLOBAL_BUILTIN                          = 48;
+constexpr int WITH_EXCEPT_START                            = 49;
+constexpr int GET_AITER                                    = 50;
+constexpr int GET_ANEXT                                    = 51;
+constexpr int BEFORE_ASYNC_WITH                            = 52;
+constexpr int BEFORE_WITH                                  = 53;
+constexpr int END_ASYNC_FOR                                = 54;
+constexpr int LOAD_GLOBAL_MODULE                           = 55;
+constexpr int LOAD_METHOD_ADAPTIVE                         = 56;
+constexpr int LOAD_METHOD_CLASS                            = 57;
+constexpr int LOAD_METHOD_MODULE                           = 58;
+constexpr int LOAD_METHOD_NO_DICT                          = 59;
+constexpr int STORE_SUBSCR                                 = 60;
+constexpr int DELETE_SUBSCR                                = 61;
+constexpr int LOAD_METHOD_WITH_DICT                        = 62;
+constexpr int LOAD_METHOD_WITH_VALUES                      = 63;
+constexpr int PRECALL_ADAPTIVE                             = 64;
+constexpr int PRECALL_BOUND_METHOD                         = 65;
+constexpr int PRECALL_BUILTIN_CLASS                        = 66;
+constexpr int PRECALL_BUILTIN_FAST_WITH_KEYWORDS           = 67;
+constexpr int GET_ITER                                     = 68;
+constexpr int GET_YIELD_FROM_ITER                          = 69;
+constexpr int PRINT_EXPR                                   = 70;
+constexpr int LOAD_BUILD_CLASS                             = 71;
+constexpr int PRECALL_METHOD_DESCRIPTOR_FAST_WITH_KEYWORDS = 72;
+constexpr int PRECALL_NO_KW_BUILTIN_FAST                   = 73;
+constexpr int LOAD_ASSERTION_ERROR                         = 74;
+constexpr int RETURN_GENERATOR                             = 75;
+constexpr int PRECALL_NO_KW_BUILTIN_O                      = 76;
+constexpr int PRECALL_NO_KW_ISINSTANCE                     = 77;
+constexpr int PRECALL_NO_KW_LEN                            = 78;
+constexpr int PRECALL_NO_KW_LIST_APPEND                    = 79;
+constexpr int PRECALL_NO_KW_METHOD_DESCRIPTOR_FAST         = 80;
+constexpr int PRECALL_NO_KW_METHOD_DESCRIPTOR_NOARGS       = 81;
+constexpr int LIST_TO_TUPLE                                = 82;
+constexpr int RETURN_VALUE                                 = 83;
+constexpr int IMPORT_STAR                                  = 84;
+constexpr int SETUP_ANNOTATIONS                            = 85;
+constexpr int YIELD_VALUE                                  = 86;
+constexpr int ASYNC_GEN_WRAP                               = 87;
+constexpr int PREP_RERAISE_STAR                            = 88;
+constexpr int POP_EXCEPT                                   = 89;
+constexpr int STORE_NAME                                   = 90;
+constexpr int DELETE_NAME                                  = 91;
+constexpr int UNPACK_SEQUENCE                              = 92;
+constexpr int FOR_ITER                                     = 93;
+constexpr int UNPACK_EX                                    = 94;
+constexpr int STORE_ATTR                                   = 95;
+constexpr int DELETE_ATTR                                  = 96;
+constexpr int STORE_GLOBAL                                 = 97;
+constexpr int DELETE_GLOBAL                                = 98;
+constexpr int SWAP                                         = 99;
+constexpr int LOAD_CONST                                   = 100;
+constexpr int LOAD_NAME                                    = 101;
+constexpr int BUILD_TUPLE                                  = 102;
+constexpr int BUILD_LIST                                   = 103;
+constexpr int BUILD_SET                                    = 104;
+constexpr int BUILD_MAP                                    = 105;
+constexpr int LOAD_ATTR                                    = 106;
+constexpr int COMPARE_OP                                   = 107;
+constexpr int IMPORT_NAME                                  = 108;
+constexpr int IMPORT_FROM                                  = 109;
+constexpr int JUMP_FORWARD                                 = 110;
+constexpr int JUMP_IF_FALSE_OR_POP                         = 111;
+constexpr int JUMP_IF_TRUE_OR_POP                          = 112;
+constexpr int PRECALL_NO_KW_METHOD_DESCRIPTOR_O            = 113;
+constexpr int POP_JUMP_FORWARD_IF_FALSE                    = 114;
+constexpr int POP_JUMP_FORWARD_IF_TRUE                     = 115;
+constexpr int LOAD_GLOBAL                                  = 116;
+constexpr int IS_OP                                        = 117;
+constexpr int CONTAINS_OP                                  = 118;
+constexpr int RERAISE                                      = 119;
+constexpr int COPY                                         = 120;
+constexpr int PRECALL_NO_KW_STR_1                          = 121;
+constexpr int BINARY_OP                                    = 122;
+constexpr int SEND                                         = 123;
+constexpr int LOAD_FAST                                    = 124;
+constexpr int STORE_FAST                                   = 125;
+constexpr int DELETE_FAST                                  = 126;
+constexpr int PRECALL_NO_KW_TUPLE_1                        = 127;
+constexpr int POP_JUMP_FORWARD_IF_NOT_NONE                 = 128;
+constexpr int POP_JUMP_FORWARD_IF_NONE                     = 129;
+constexpr int RAISE_VARARGS                                = 130;
+constexpr int GET_AWAITABLE                                = 131;
+constexpr int MAKE_FUNCTION                                = 132;
+constexpr int BUILD_SLICE                                  = 133;
+constexpr int JUMP_BACKWARD_NO_INTERRUPT                   = 134;
+constexpr int MAKE_CELL                                    = 135;
+constexpr int LOAD_CLOSURE                                 = 136;
+constexpr int LOAD_DEREF                                   = 137;
+constexpr int STORE_DEREF                                  = 138;
+constexpr int DELETE_DEREF                                 = 139;
+constexpr int JUMP_BACKWARD                                = 140;
+constexpr int PRECALL_NO_KW_TYPE_1                         = 141;
+constexpr int CALL_FUNCTION_EX                             = 142;
+constexpr int PRECALL_PYFUNC                               = 143;
+constexpr int EXTENDED_ARG                                 = 144;
+constexpr int LIST_APPEND                                  = 145;
+constexpr int SET_ADD                                      = 146;
+constexpr int MAP_ADD                                      = 147;
+constexpr int LOAD_CLASSDEREF                              = 148;
+constexpr int COPY_FREE_VARS                               = 149;
+constexpr int RESUME_QUICK                                 = 150;
+constexpr int RESUME                                       = 151;
+constexpr int MATCH_CLASS                                  = 152;
+constexpr int STORE_ATTR_ADAPTIVE                          = 153;
+constexpr int STORE_ATTR_INSTANCE_VALUE                    = 154;
+constexpr int FORMAT_VALUE                                 = 155;
+constexpr int BUILD_CONST_KEY_MAP                          = 156;
+constexpr int BUILD_STRING                                 = 157;
+constexpr int STORE_ATTR_SLOT                              = 158;
+constexpr int STORE_ATTR_WITH_HINT                         = 159;
+constexpr int LOAD_METHOD                                  = 160;
+constexpr int STORE_FAST__LOAD_FAST                        = 161;
+constexpr int LIST_EXTEND                                  = 162;
+constexpr int SET_UPDATE                                   = 163;
+constexpr int DICT_MERGE                                   = 164;
+constexpr int DICT_UPDATE                                  = 165;
+constexpr int PRECALL                                      = 166;
+constexpr int STORE_FAST__STORE_FAST                       = 167;
+constexpr int STORE_SUBSCR_ADAPTIVE                        = 168;
+constexpr int STORE_SUBSCR_DICT                            = 169;
+constexpr int STORE_SUBSCR_LIST_INT                        = 170;
+constexpr int CALL                                         = 171;
+constexpr int KW_NAMES                                     = 172;
+constexpr int POP_JUMP_BACKWARD_IF_NOT_NONE                = 173;
+constexpr int POP_JUMP_BACKWARD_IF_NONE                    = 174;
+constexpr int POP_JUMP_BACKWARD_IF_FALSE                   = 175;
+constexpr int POP_JUMP_BACKWARD_IF_TRUE                    = 176;
+constexpr int UNPACK_SEQUENCE_ADAPTIVE                     = 177;
+constexpr int UNPACK_SEQUENCE_LIST                         = 178;
+constexpr int UNPACK_SEQUENCE_TUPLE                        = 179;
+constexpr int UNPACK_SEQUENCE_TWO_TUPLE                    = 180;
+constexpr int DO_TRACING                                   = 255;
+
+// Indexed by opcode, empty for values the interpreter does not use
+constexpr std::array<std::string_view, 256> names{
+    "CACHE", "POP_TOP", "PUSH_NULL", "BINARY_OP_ADAPTIVE",
+    "BINARY_OP_ADD_FLOAT", "BINARY_OP_ADD_INT", "BINARY_OP_ADD_UNICODE", "BINARY_OP_INPLACE_ADD_UNICODE",
+    "BINARY_OP_MULTIPLY_FLOAT", "NOP", "UNARY_POSITIVE", "UNARY_NEGATIVE",
+    "UNARY_NOT", "BINARY_OP_MULTIPLY_INT", "BINARY_OP_SUBTRACT_FLOAT", "UNARY_INVERT",
+    "BINARY_OP_SUBTRACT_INT", "BINARY_SUBSCR_ADAPTIVE", "BINARY_SUBSCR_DICT", "BINARY_SUBSCR_GETITEM",
+    "BINARY_SUBSCR_LIST_INT", "BINARY_SUBSCR_TUPLE_INT", "CALL_ADAPTIVE", "CALL_PY_EXACT_ARGS",
+    "CALL_PY_WITH_DEFAULTS", "BINARY_SUBSCR", "COMPARE_OP_ADAPTIVE", "COMPARE_OP_FLOAT_JUMP",
+    "COMPARE_OP_INT_JUMP", "COMPARE_OP_STR_JUMP", "GET_LEN", "MATCH_MAPPING",
+    "MATCH_SEQUENCE", "MATCH_KEYS", "EXTENDED_ARG_QUICK", "PUSH_EXC_INFO",
+    "CHECK_EXC_MATCH", "CHECK_EG_MATCH", "JUMP_BACKWARD_QUICK", "LOAD_ATTR_ADAPTIVE",
+    "LOAD_ATTR_INSTANCE_VALUE", "LOAD_ATTR_MODULE", "LOAD_ATTR_SLOT", "LOAD_ATTR_WITH_HINT",
+    "LOAD_CONST__LOAD_FAST", "LOAD_FAST__LOAD_CONST", "LOAD_FAST__LOAD_FAST", "LOAD_GLOBAL_ADAPTIVE",
+    "LOAD_GLOBAL_BUILTIN", "WITH_EXCEPT_START", "GET_AITER", "GET_ANEXT",
+    "BEFORE_ASYNC_WITH", "BEFORE_WITH", "END_ASYNC_FOR", "LOAD_GLOBAL_MODULE",
+    "LOAD_METHOD_ADAPTIVE", "LOAD_METHOD_CLASS", "LOAD_METHOD_MODULE", "LOAD_METHOD_NO_DICT",
+    "STORE_SUBSCR", "DELETE_SUBSCR", "LOAD_METHOD_WITH_DICT", "LOAD_METHOD_WITH_VALUES",
+    "PRECALL_ADAPTIVE", "PRECALL_BOUND_METHOD", "PRECALL_BUILTIN_CLASS", "PRECALL_BUILTIN_FAST_WITH_KEYWORDS",
+    "GET_ITER", "GET_YIELD_FROM_ITER", "PRINT_EXPR", "LOAD_BUILD_CLASS",
+    "PRECALL_METHOD_DESCRIPTOR_FAST_WITH_KEYWORDS", "PRECALL_NO_KW_BUILTIN_FAST", "LOAD_ASSERTION_ERROR", "RETURN_GENERATOR",
+    "PRECALL_NO_KW_BUILTIN_O", "PRECALL_NO_KW_ISINSTANCE", "PRECALL_NO_KW_LEN", "PRECALL_NO_KW_LIST_APPEND",
+    "PRECALL_NO_KW_METHOD_DESCRIPTOR_FAST", "PRECALL_NO_KW_METHOD_DESCRIPTOR_NOARGS", "LIST_TO_TUPLE", "RETURN_VALUE",
+    "IMPORT_STAR", "SETUP_ANNOTATIONS", "YIELD_VALUE", "ASYNC_GEN_WRAP",
+    "PREP_RERAISE_STAR", "POP_EXCEPT", "STORE_NAME", "DELETE_NAME",
+    "UNPACK_SEQUENCE", "FOR_ITER", "UNPACK_EX", "STORE_ATTR",
+    "DELETE_ATTR", "STORE_GLOBAL", "DELETE_GLOBAL", "SWAP",
+    "LOAD_CONST", "LOAD_NAME", "BUILD_TUPLE", "BUILD_LIST",
+    "BUILD_SET", "BUILD_MAP", "LOAD_ATTR", "COMPARE_OP",
+    "IMPORT_NAME", "IMPORT_FROM", "JUMP_FORWARD", "JUMP_IF_FALSE_OR_POP",
+    "JUMP_IF_TRUE_OR_POP", "PRECALL_NO_KW_METHOD_DESCRIPTOR_O", "POP_JUMP_FORWARD_IF_FALSE", "POP_JUMP_FORWARD_IF_TRUE",
+    "LOAD_GLOBAL", "IS_OP", "CONTAINS_OP", "RERAISE",
+    "COPY", "PRECALL_NO_KW_STR_1", "BINARY_OP", "SEND",
+    "LOAD_FAST", "STORE_FAST", "DELETE_FAST", "PRECALL_NO_KW_TUPLE_1",
+    "POP_JUMP_FORWARD_IF_NOT_NONE", "POP_JUMP_FORWARD_IF_NONE", "RAISE_VARARGS", "GET_AWAITABLE",
+    "MAKE_FUNCTION", "BUILD_SLICE", "JUMP_BACKWARD_NO_INTERRUPT", "MAKE_CELL",
+    "LOAD_CLOSURE", "LOAD_DEREF", "STORE_DEREF", "DELETE_DEREF",
+    "JUMP_BACKWARD", "PRECALL_NO_KW_TYPE_1", "CALL_FUNCTION_EX", "PRECALL_PYFUNC",
+    "EXTENDED_ARG", "LIST_APPEND", "SET_ADD", "MAP_ADD",
+    "LOAD_CLASSDEREF", "COPY_FREE_VARS", "RESUME_QUICK", "RESUME",
+    "MATCH_CLASS", "STORE_ATTR_ADAPTIVE", "STORE_ATTR_INSTANCE_VALUE", "FORMAT_VALUE",
+    "BUILD_CONST_KEY_MAP", "BUILD_STRING", "STORE_ATTR_SLOT", "STORE_ATTR_WITH_HINT",
+    "LOAD_METHOD", "STORE_FAST__LOAD_FAST", "LIST_EXTEND", "SET_UPDATE",
+    "DICT_MERGE", "DICT_UPDATE", "PRECALL", "STORE_FAST__STORE_FAST",
+    "STORE_SUBSCR_ADAPTIVE", "STORE_SUBSCR_DICT", "STORE_SUBSCR_LIST_INT", "CALL",
+    "KW_NAMES", "POP_JUMP_BACKWARD_IF_NOT_NONE", "POP_JUMP_BACKWARD_IF_NONE", "POP_JUMP_BACKWARD_IF_FALSE",
+    "POP_JUMP_BACKWARD_IF_TRUE", "UNPACK_SEQUENCE_ADAPTIVE", "UNPACK_SEQUENCE_LIST", "UNPACK_SEQUENCE_TUPLE",
+    "UNPACK_SEQUENCE_TWO_TUPLE", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "",
+    "", "", "", "DO_TRACING",
+};
+} // namespace bytecode_opcode
+
+#endif
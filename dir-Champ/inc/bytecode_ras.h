@@ -0,0 +1,59 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_RAS_H
+#define BYTECODE_RAS_H
+
+#include <cstdint>
+#include <vector>
+
+constexpr std::size_t BYTECODE_RAS_DEPTH = 16;
+
+// What a push onto a full stack does: overwrite the oldest return address, or drop the new one
+enum class RAS_OVERFLOW { OVERWRITE, DISCARD };
+
+struct RAS_STATS {
+    uint64_t pushes = 0;
+    uint64_t pops = 0;
+    uint64_t hits = 0;
+    uint64_t miss = 0;
+    uint64_t overflows = 0;
+    uint64_t underflows = 0;
+    uint64_t frameless_calls = 0; // Calls whose next bytecode was the return address, i.e. calls into C
+};
+
+class BYTECODE_RAS {
+    std::size_t depth;
+    RAS_OVERFLOW overflow;
+
+    // Circular stack, top is the newest return address
+    std::vector<uint64_t> stack;
+    std::size_t top = 0;
+    std::size_t size = 0;
+    // Pushes dropped on overflow, their returns must not pop the addresses beneath them
+    std::size_t discarded = 0;
+
+ public:
+    RAS_STATS stats;
+
+    BYTECODE_RAS() : BYTECODE_RAS(BYTECODE_RAS_DEPTH, RAS_OVERFLOW::OVERWRITE) {}
+    BYTECODE_RAS(std::size_t ras_depth, RAS_OVERFLOW overflow_policy);
+
+    // CALL* bytecodes push, RETURN_VALUE, YIELD_VALUE and SEND pop
+    static bool isCall(int opcode);
+    static bool isReturn(int opcode);
+    // Bytes from a call's BPC to the bytecode after its inline cache
+    static uint64_t returnOffset(int opcode);
+
+    void push(uint64_t return_bpc);
+    // Predicted return BPC, 0 when the stack has nothing to predict with
+    uint64_t pop();
+    // Undo the last push, for calls that returned without running a bytecode frame
+    void popFrameless(uint64_t return_bpc);
+    uint64_t storageBits() const;
+    void resetStats();
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifdef CHAMPSIM_MODULE
+#define SET_ASIDE_CHAMPSIM_MODULE
+#undef CHAMPSIM_MODULE
+#endif
+
+#ifndef BYTECODE_TAGE_H
+#define BYTECODE_TAGE_H
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "bytecode_btb.h"
+
+// Tagged tables on top of the DBTB, indexed with a hash of the recent (opcode, BPC delta) history
+constexpr std::size_t TAGE_NUM_TABLES = 4;
+constexpr std::size_t TAGE_LOG_ENTRIES = 7;
+constexpr std::size_t TAGE_TAG_BITS = 9;
+constexpr std::size_t TAGE_JUMP_BITS = DBTB_JUMP_BITS;
+constexpr std::size_t TAGE_CTR_BITS = 2;
+constexpr std::size_t TAGE_USEFUL_BITS = 2;
+constexpr std::array<std::size_t, TAGE_NUM_TABLES> TAGE_HISTORY_LENGTHS = {2, 4, 8, 16};
+constexpr std::size_t TAGE_MAX_HISTORY = TAGE_HISTORY_LENGTHS.back();
+constexpr uint64_t TAGE_USEFUL_RESET_PERIOD = 1 << 18;
+
+enum class BYTECODE_TARGET_PREDICTOR { DBTB, TAGE };
+
+struct TAGE_STATS {
+    std::array<uint64_t, TAGE_NUM_TABLES> provider_predictions = {};
+    std::array<uint64_t, TAGE_NUM_TABLES> provider_correct = {};
+    uint64_t base_predictions = 0;
+    uint64_t base_correct = 0;
+    uint64_t allocations = 0;
+    uint64_t failed_allocations = 0;
+};
+
+struct TAGE_ENTRY {
+    uint16_t tag = 0;
+    int64_t jump = 0;
+    int8_t ctr = 0;
+    uint8_t useful = 0;
+    bool valid = false;
+};
+
+class BYTECODE_TAGE {
+    std::array<std::vector<TAGE_ENTRY>, TAGE_NUM_TABLES> tables;
+
+    // Circular buffer of hashed (opcode, BPC delta) events, newest at history_head
+    std::array<uint16_t, TAGE_MAX_HISTORY> history = {};
+    std::size_t history_head = 0;
+    std::array<uint64_t, TAGE_NUM_TABLES> index_hash = {};
+    std::array<uint64_t, TAGE_NUM_TABLES> tag_hash = {};
+    uint64_t updates = 0;
+
+    // Lookup state kept from the last prediction, used by the update that follows it
+    std::array<std::size_t, TAGE_NUM_TABLES> last_index = {};
+    std::array<uint16_t, TAGE_NUM_TABLES> last_tag = {};
+    int provider = -1;
+    int alternate = -1;
+
+    void computeHashes();
+    void lookup(int opcode, int oparg, uint64_t bpc);
+    void pushHistory(int opcode, int64_t jump);
+
+ public:
+    TAGE_STATS stats;
+
+    BYTECODE_TAGE();
+    int64_t prediction(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc);
+    // Jump and the counter of the entry that provided it, or the base DBTB's confidence when it predicted
+    std::pair<int64_t, int> predictionWithConfidence(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc);
+    void update(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc, int64_t correct_jump);
+    uint64_t storageBits() const;
+    void resetStats();
+};
+
+#endif
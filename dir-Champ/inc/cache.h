@@ -66,6 +66,12 @@ struct cache_stats {
   uint64_t total_miss_latency_dispatch_table = 0;
 };
 
+// Prefetcher metadata of a bytecode hint: the opcode in the low byte, the low oparg bits above it, a bit that tells
+// it apart from a BB fill fetched through this cache, and the top bit set when the bytecode is only predicted to run next
+constexpr unsigned BYTECODE_HINT_OPARG_BITS = 22;
+constexpr uint32_t BYTECODE_HINT_VALID = 1u << 30;
+constexpr uint32_t BYTECODE_HINT_LOOKAHEAD = 1u << 31;
+
 class CACHE : public champsim::operable
 {
   enum [[deprecated(
@@ -116,6 +122,7 @@ class CACHE : public champsim::operable
 
     access_type type;
     bool prefetch_from_this;
+    bool skip_fill;
     LOAD_TYPE ld_type = LOAD_TYPE::NOT_IMPLEMENTED;
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
@@ -145,6 +152,7 @@ class CACHE : public champsim::operable
     bool prefetch = false;
     bool dirty = false;
     bool bytecode = false;
+    LOAD_TYPE ld_type = LOAD_TYPE::NOT_IMPLEMENTED;
 
     uint64_t address = 0;
     uint64_t v_address = 0;
@@ -228,6 +236,10 @@ public:
   [[deprecated("This function should not be used to access the blocks directly.")]] uint64_t get_way(uint64_t address, uint64_t set) const;
 
   uint64_t invalidate_entry(uint64_t inval_addr);
+  // Whether the block holding v_address is valid, only meaningful for virtually indexed caches like the L1I
+  bool probe_virtual(uint64_t v_address) const;
+  // Hands a bytecode to the prefetcher as a BLW access at its BPC, with the opcode and oparg as metadata
+  void bytecode_operate(uint64_t bpc, uint64_t instr_id, int opcode, int oparg, bool lookahead);
   int prefetch_line(uint64_t pf_addr, bool fill_this_level, LOAD_TYPE ld_type, uint32_t prefetch_metadata);
   int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
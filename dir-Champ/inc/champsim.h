@@ -17,8 +17,10 @@
 #ifndef CHAMPSIM_H
 #define CHAMPSIM_H
 
+#include <array>
 #include <cstdint>
 #include <exception>
+#include <string_view>
 
 namespace champsim
 {
@@ -35,12 +37,15 @@ constexpr bool debug_print = true;
 constexpr bool debug_print = false;
 #endif
 
-#define SKIP_DISPATCH
-#ifdef SKIP_DISPATCH
-constexpr bool skip_dispatch = true; 
-#else
-constexpr bool skip_dispatch = false; 
-#endif
+// How the core handles the interpreter's dispatch, chosen with --dispatch-mode:
+//   NO_SKIP  fetches and runs every dispatch instruction
+//   SKIP     skips dispatch through the BB and HDBT, with every configured bytecode prefetcher
+//   IDEAL    skips dispatch as if the BB, HDBT and bytecode target prediction never missed
+//   MINIMAL  skips dispatch through the BB and HDBT alone, without fusion or any bytecode prefetcher
+enum class dispatch_mode { NO_SKIP, SKIP, IDEAL, MINIMAL };
+constexpr std::array<std::string_view, 4> dispatch_mode_names{"no-skip", "skip", "ideal", "minimal"};
+
+constexpr bool skips_dispatch(dispatch_mode mode) { return mode != dispatch_mode::NO_SKIP; }
 
 } // namespace champsim
 
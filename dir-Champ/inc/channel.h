@@ -54,6 +54,9 @@ enum class access_type : unsigned {
 using namespace std::literals::string_view_literals;
 inline constexpr std::array<std::string_view, static_cast<std::size_t>(access_type::NUM_TYPES)> access_type_names{"LOAD"sv, "RFO"sv, "PREFETCH"sv, "WRITE"sv,
                                                                                                                   "TRANSLATION"};
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(LOAD_TYPE::MISS_BPC_PRED) + 1> load_type_names{
+    "NOT_IMPLEMENTED"sv, "NOT_LOAD"sv, "STANDARD_DATA"sv, "BLW"sv, "BTG"sv, "JUMP_POINT"sv, "INITIAL_POINT"sv, "COMBINED_JUMP"sv, "OTHER_DISPATCH_JUMP"sv,
+    "NOT_SKIP"sv, "MISS_BPC_PRED"sv};
 
 namespace champsim
 {
@@ -80,6 +83,7 @@ class channel
     bool forward_checked = false;
     bool is_translated = true;
     bool response_requested = true;
+    bool skip_fill = false; // Looked up and passed through without allocating a block, the next level fills it
     LOAD_TYPE ld_type = LOAD_TYPE::NOT_IMPLEMENTED;
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
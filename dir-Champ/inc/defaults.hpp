@@ -28,6 +28,39 @@ const auto default_core = O3_CPU::Builder{}
                               .dib_set(32)
                               .dib_way(8)
                               .dib_window(16)
+                              .bb_rows(6)
+                              .bb_row_size(8)
+                              .bb_runahead_depth(0)
+                              .bb_runahead_confidence(2)
+                              .bb_dual_path_confidence(0)
+                              .reset_bb_sectored()
+                              .bb_coherence(BB_COHERENCE::NONE)
+                              .bb_fill_level(BB_FILL_LEVEL::L1I)
+                              .reset_bb_predecode()
+                              .reset_bb_operand_hints()
+                              .bb_fill_width(0)
+                              .reset_bb_early_restart()
+                              .hdbt_sets(64)
+                              .hdbt_ways(4)
+                              .hdbt_replacement(HDBT_REPLACEMENT::LRU)
+                              .hdbt_prefetch_depth(0)
+                              .dbtb_entries(256)
+                              .dbtb_oparg_sets(0)
+                              .dbtb_oparg_ways(4)
+                              .bytecode_target_predictor(BYTECODE_TARGET_PREDICTOR::DBTB)
+                              .bytecode_direction_entries(0)
+                              .bytecode_direction_history(8)
+                              .bytecode_ras_depth(16)
+                              .bytecode_ras_overflow(RAS_OVERFLOW::OVERWRITE)
+                              .fusion_entries(0)
+                              .fusion_threshold(8)
+                              .bytecode_loop_entries(0)
+                              .bytecode_loop_prefetch_distance(2)
+                              .bytecode_l1_size(0)
+                              .bytecode_l1_ways(4)
+                              .bytecode_l1_latency(2)
+                              .bytecode_l1_mshr_size(4)
+                              .bytecode_context_switch(BYTECODE_CONTEXT_SWITCH::NONE)
                               .ifetch_buffer_size(64)
                               .decode_buffer_size(32)
                               .dispatch_buffer_size(32)
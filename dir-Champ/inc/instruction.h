@@ -73,6 +73,13 @@ struct ooo_model_instr {
   uint64_t load_val = 0;
   uint32_t load_size = 0;
 
+  // Opcode of the bytecode whose BLW started this instruction's region, -1 before the first one
+  int bytecode_opcode = -1;
+  // Dispatch instruction that runs because the HDBT missed, a hit would have skipped it
+  bool hdbt_miss_dispatch = false;
+  // When the fetch of its block went to the L1I, it has missed once it takes longer than a hit
+  uint64_t fetch_issue_cycle = 0;
+
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
 
   uint8_t branch_type = NOT_BRANCH;
@@ -85,7 +85,21 @@ struct bytecode_map_entry {
   uint64_t ip = 0;
 };
 
+// What a cycle goes to in the per-opcode top-down accounting: retiring instructions, or why the ROB head or fetch stalls
+enum class CYCLE_CAUSE : std::size_t { RETIRING, BB_MISS, HDBT_MISS, BYTECODE_MISPREDICT, L1I_MISS, L1D_MISS, BACKEND, FRONTEND, NUM_CAUSES };
+constexpr std::array<std::string_view, champsim::to_underlying(CYCLE_CAUSE::NUM_CAUSES)> cycle_cause_names{
+    "retiring", "BB miss", "HDBT miss", "bytecode mispredict", "L1I miss", "L1D miss", "backend", "frontend"};
+
+struct OPCODE_CYCLES {
+  uint64_t bytecodes = 0;
+  uint64_t instrs = 0;
+  std::array<uint64_t, champsim::to_underlying(CYCLE_CAUSE::NUM_CAUSES)> cycles = {};
+
+  uint64_t total() const { return std::accumulate(std::begin(cycles), std::end(cycles), uint64_t{0}); }
+};
+
 struct cpu_stats {
+  champsim::dispatch_mode dispatch = champsim::dispatch_mode::SKIP;
   BB_STATS bb_stats;
   BYTCODE_MODULE_STATS bb_mod;
   HDBT_STATS hdbt_stats;
@@ -109,6 +123,8 @@ struct cpu_stats {
   std::map<uint64_t, uint64_t> lengthBetweenBytecodeAndTable;
   uint64_t totalFound = 0;
   std::map<int, uint64_t> bytecodeCounts; 
+  // Indexed by the opcode of the bytecode each cycle and retired instruction belongs to, plus one for those before the first (-1)
+  std::array<OPCODE_CYCLES, DBTB_NUM_OPCODES + 1> opcode_cycles = {};
   uint64_t miss_BPC_pred_penalty = 0;
   uint64_t miss_bpc = 0;
   uint64_t bpc_max = 0;
@@ -150,6 +166,18 @@ struct cpu_stats {
     return std::accumulate(bytecodeCounts.begin(), bytecodeCounts.end(), 
     0, [] (int value, const std::map<int, int>::value_type& p)  { return value + p.second; });
   }
+  OPCODE_CYCLES& opcodeCycles(int opcode) { return opcode_cycles[static_cast<std::size_t>(opcode + 1)]; }
+  // The opcodes that were seen, most cycles first
+  std::vector<std::pair<int, OPCODE_CYCLES>> opcodeCyclesByTotal() const {
+    std::vector<std::pair<int, OPCODE_CYCLES>> sorted;
+    for (std::size_t index = 0; index < std::size(opcode_cycles); ++index) {
+      auto const& cycles = opcode_cycles[index];
+      if (cycles.bytecodes > 0 || cycles.instrs > 0 || cycles.total() > 0)
+        sorted.emplace_back(static_cast<int>(index) - 1, cycles);
+    }
+    std::stable_sort(std::begin(sorted), std::end(sorted), [](const auto& lhs, const auto& rhs) { return lhs.second.total() > rhs.second.total(); });
+    return sorted;
+  }
 };
 
 struct LSQ_ENTRY {
@@ -161,6 +189,7 @@ struct LSQ_ENTRY {
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
   bool fetch_issued = false;
+  uint64_t issue_cycle = 0; // When the load went to the L1D, it has missed once it takes longer than a hit
 
   uint64_t producer_id = std::numeric_limits<uint64_t>::max();
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
@@ -190,6 +219,10 @@ public:
 
   bool show_heartbeat = true;
 
+  // Set before initialization, the BTB is sized for it and every phase runs the fetch stages specialised for it
+  champsim::dispatch_mode dispatch = champsim::dispatch_mode::SKIP;
+  bool skips_dispatch() const { return champsim::skips_dispatch(dispatch); }
+
   using stats_type = cpu_stats;
 
   stats_type roi_stats{}, sim_stats{};
@@ -223,6 +256,11 @@ public:
   std::set<uint64_t> weirdNonSkips;
   bool miss_BPC_pred = false;
   uint64_t miss_BPC_cycle = 0;
+  // Opcode of the last BLW fetch went through, and the end of the dispatch an HDBT miss made fetch run
+  int fetch_opcode = -1;
+  uint64_t hdbt_miss_dispatch_end = 0;
+  // BPCs whose rows a dual path or run-ahead fill may not take, kept here so the lookups do not allocate
+  std::vector<uint64_t> protected_bpcs;
 
 
   // Constants
@@ -249,15 +287,30 @@ public:
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
+  CACHE* l1d;
   BYTECODE_MODULE bytecode_module;
   bool bytecode_buffer_miss = false;
+  // Without skipping, pre-decode the BB to install dispatch jump targets in the BTB
+  const bool BB_PREDECODE;
+  // Hand every bytecode, and the next one when the BB holds it, to the L1D prefetcher
+  const bool BB_OPERAND_HINTS;
+  BB_FILL_LEVEL BB_FILL_FROM;
 
   void initialize() override final;
   long operate() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
 
+  // Fetch and memory stages specialised for each dispatch mode, the ones for the current mode are picked at phase start
+  void (O3_CPU::*initialize_instruction_stage)() = nullptr;
+  long (O3_CPU::*check_dib_stage)() = nullptr;
+  long (O3_CPU::*operate_lsq_stage)() = nullptr;
+  long (O3_CPU::*handle_memory_return_stage)() = nullptr;
+  void select_dispatch_stages();
+
+  template <champsim::dispatch_mode MODE>
   void initialize_instruction();
+  template <champsim::dispatch_mode MODE>
   long check_dib();
   long fetch_instruction();
   long promote_to_decode();
@@ -265,14 +318,19 @@ public:
   long dispatch_instruction();
   long schedule_instruction();
   long execute_instruction();
+  template <champsim::dispatch_mode MODE>
   long operate_lsq();
   long complete_inflight_instruction();
+  template <champsim::dispatch_mode MODE>
   long handle_memory_return();
   long retire_rob();
+  // Charges a cycle in which nothing retired to the opcode and cause of the stall
+  void account_stall_cycle();
 
   bool do_init_instruction(ooo_model_instr& instr);
   void jump_ahead(ooo_model_instr& instr);
   bool do_predict_branch(ooo_model_instr& instr);
+  template <champsim::dispatch_mode MODE>
   void do_check_dib(ooo_model_instr& instr);
   bool do_fetch_instruction(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end);
   void do_dib_update(const ooo_model_instr& instr);
@@ -283,6 +341,7 @@ public:
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
 
   void do_finish_store(const LSQ_ENTRY& sq_entry);
+  template <champsim::dispatch_mode MODE>
   bool do_complete_store(const LSQ_ENTRY& sq_entry);
   bool execute_load(const LSQ_ENTRY& lq_entry);
 
@@ -350,6 +409,39 @@ public:
     std::size_t m_dib_set{};
     std::size_t m_dib_way{};
     std::size_t m_dib_window{};
+    std::size_t m_bb_rows{};
+    uint64_t m_bb_row_size{};
+    std::size_t m_bb_runahead_depth{};
+    int m_bb_runahead_confidence{};
+    int m_bb_dual_path_confidence{};
+    bool m_bb_sectored{};
+    bool m_bb_predecode{};
+    bool m_bb_operand_hints{};
+    uint64_t m_bb_fill_width{};
+    bool m_bb_early_restart{};
+    BB_COHERENCE m_bb_coherence{};
+    BB_FILL_LEVEL m_bb_fill_level{};
+    std::size_t m_hdbt_sets{};
+    std::size_t m_hdbt_ways{};
+    HDBT_REPLACEMENT m_hdbt_replacement{};
+    std::size_t m_hdbt_prefetch_depth{};
+    std::size_t m_dbtb_entries{};
+    std::size_t m_dbtb_oparg_sets{};
+    std::size_t m_dbtb_oparg_ways{};
+    BYTECODE_TARGET_PREDICTOR m_bytecode_target_predictor{};
+    std::size_t m_bytecode_direction_entries{};
+    std::size_t m_bytecode_direction_history{};
+    std::size_t m_bytecode_ras_depth{};
+    RAS_OVERFLOW m_bytecode_ras_overflow{};
+    std::size_t m_fusion_entries{};
+    unsigned m_fusion_threshold{};
+    std::size_t m_bytecode_loop_entries{};
+    std::size_t m_bytecode_loop_prefetch_distance{};
+    std::size_t m_bytecode_l1_size{};
+    std::size_t m_bytecode_l1_ways{};
+    uint64_t m_bytecode_l1_latency{};
+    std::size_t m_bytecode_l1_mshr_size{};
+    BYTECODE_CONTEXT_SWITCH m_bytecode_context_switch{};
     std::size_t m_ifetch_buffer_size{};
     std::size_t m_decode_buffer_size{};
     std::size_t m_dispatch_buffer_size{};
@@ -371,6 +463,7 @@ public:
     unsigned m_execute_latency{};
 
     CACHE* m_l1i{};
+    CACHE* m_l1d{};
     long int m_l1i_bw{};
     long int m_l1d_bw{};
     champsim::channel* m_fetch_queues{};
@@ -381,13 +474,22 @@ public:
     template <unsigned long long OTHER_B, unsigned long long OTHER_T>
     Builder(builder_conversion_tag, const Builder<OTHER_B, OTHER_T>& other)
         : m_cpu(other.m_cpu), m_freq_scale(other.m_freq_scale), m_dib_set(other.m_dib_set), m_dib_way(other.m_dib_way), m_dib_window(other.m_dib_window),
+          m_bb_rows(other.m_bb_rows), m_bb_row_size(other.m_bb_row_size),
+          m_bb_runahead_depth(other.m_bb_runahead_depth), m_bb_runahead_confidence(other.m_bb_runahead_confidence), m_bb_dual_path_confidence(other.m_bb_dual_path_confidence), m_bb_sectored(other.m_bb_sectored), m_bb_predecode(other.m_bb_predecode), m_bb_operand_hints(other.m_bb_operand_hints), m_bb_fill_width(other.m_bb_fill_width), m_bb_early_restart(other.m_bb_early_restart), m_bb_coherence(other.m_bb_coherence), m_bb_fill_level(other.m_bb_fill_level), m_hdbt_sets(other.m_hdbt_sets), m_hdbt_ways(other.m_hdbt_ways), m_hdbt_replacement(other.m_hdbt_replacement),
+          m_hdbt_prefetch_depth(other.m_hdbt_prefetch_depth),
+          m_dbtb_entries(other.m_dbtb_entries), m_dbtb_oparg_sets(other.m_dbtb_oparg_sets), m_dbtb_oparg_ways(other.m_dbtb_oparg_ways), m_bytecode_target_predictor(other.m_bytecode_target_predictor),
+          m_bytecode_direction_entries(other.m_bytecode_direction_entries), m_bytecode_direction_history(other.m_bytecode_direction_history), m_bytecode_ras_depth(other.m_bytecode_ras_depth),
+          m_bytecode_ras_overflow(other.m_bytecode_ras_overflow), m_fusion_entries(other.m_fusion_entries), m_fusion_threshold(other.m_fusion_threshold),
+          m_bytecode_loop_entries(other.m_bytecode_loop_entries), m_bytecode_loop_prefetch_distance(other.m_bytecode_loop_prefetch_distance),
+          m_bytecode_l1_size(other.m_bytecode_l1_size), m_bytecode_l1_ways(other.m_bytecode_l1_ways), m_bytecode_l1_latency(other.m_bytecode_l1_latency),
+          m_bytecode_l1_mshr_size(other.m_bytecode_l1_mshr_size), m_bytecode_context_switch(other.m_bytecode_context_switch),
           m_ifetch_buffer_size(other.m_ifetch_buffer_size), m_decode_buffer_size(other.m_decode_buffer_size),
           m_dispatch_buffer_size(other.m_dispatch_buffer_size), m_rob_size(other.m_rob_size), m_lq_size(other.m_lq_size), m_sq_size(other.m_sq_size),
           m_fetch_width(other.m_fetch_width), m_decode_width(other.m_decode_width), m_dispatch_width(other.m_dispatch_width),
           m_schedule_width(other.m_schedule_width), m_execute_width(other.m_execute_width), m_lq_width(other.m_lq_width), m_sq_width(other.m_sq_width),
           m_retire_width(other.m_retire_width), m_mispredict_penalty(other.m_mispredict_penalty), m_decode_latency(other.m_decode_latency),
           m_dispatch_latency(other.m_dispatch_latency), m_schedule_latency(other.m_schedule_latency), m_execute_latency(other.m_execute_latency),
-          m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
+          m_l1i(other.m_l1i), m_l1d(other.m_l1d), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
     {
     }
 
@@ -419,6 +521,191 @@ public:
       m_dib_window = dib_window_;
       return *this;
     }
+    self_type& bb_rows(std::size_t bb_rows_)
+    {
+      m_bb_rows = bb_rows_;
+      return *this;
+    }
+    self_type& bb_row_size(uint64_t bb_row_size_)
+    {
+      m_bb_row_size = bb_row_size_;
+      return *this;
+    }
+    self_type& bb_runahead_depth(std::size_t bb_runahead_depth_)
+    {
+      m_bb_runahead_depth = bb_runahead_depth_;
+      return *this;
+    }
+    self_type& bb_runahead_confidence(int bb_runahead_confidence_)
+    {
+      m_bb_runahead_confidence = bb_runahead_confidence_;
+      return *this;
+    }
+    self_type& bb_dual_path_confidence(int bb_dual_path_confidence_)
+    {
+      m_bb_dual_path_confidence = bb_dual_path_confidence_;
+      return *this;
+    }
+    self_type& set_bb_sectored()
+    {
+      m_bb_sectored = true;
+      return *this;
+    }
+    self_type& reset_bb_sectored()
+    {
+      m_bb_sectored = false;
+      return *this;
+    }
+    self_type& set_bb_predecode()
+    {
+      m_bb_predecode = true;
+      return *this;
+    }
+    self_type& reset_bb_predecode()
+    {
+      m_bb_predecode = false;
+      return *this;
+    }
+    self_type& set_bb_operand_hints()
+    {
+      m_bb_operand_hints = true;
+      return *this;
+    }
+    self_type& reset_bb_operand_hints()
+    {
+      m_bb_operand_hints = false;
+      return *this;
+    }
+    self_type& bb_fill_width(uint64_t bb_fill_width_)
+    {
+      m_bb_fill_width = bb_fill_width_;
+      return *this;
+    }
+    self_type& set_bb_early_restart()
+    {
+      m_bb_early_restart = true;
+      return *this;
+    }
+    self_type& reset_bb_early_restart()
+    {
+      m_bb_early_restart = false;
+      return *this;
+    }
+    self_type& bb_coherence(BB_COHERENCE bb_coherence_)
+    {
+      m_bb_coherence = bb_coherence_;
+      return *this;
+    }
+    self_type& bb_fill_level(BB_FILL_LEVEL bb_fill_level_)
+    {
+      m_bb_fill_level = bb_fill_level_;
+      return *this;
+    }
+    self_type& hdbt_sets(std::size_t hdbt_sets_)
+    {
+      m_hdbt_sets = hdbt_sets_;
+      return *this;
+    }
+    self_type& hdbt_ways(std::size_t hdbt_ways_)
+    {
+      m_hdbt_ways = hdbt_ways_;
+      return *this;
+    }
+    self_type& hdbt_replacement(HDBT_REPLACEMENT hdbt_replacement_)
+    {
+      m_hdbt_replacement = hdbt_replacement_;
+      return *this;
+    }
+    self_type& hdbt_prefetch_depth(std::size_t hdbt_prefetch_depth_)
+    {
+      m_hdbt_prefetch_depth = hdbt_prefetch_depth_;
+      return *this;
+    }
+    self_type& dbtb_entries(std::size_t dbtb_entries_)
+    {
+      m_dbtb_entries = dbtb_entries_;
+      return *this;
+    }
+    self_type& dbtb_oparg_sets(std::size_t dbtb_oparg_sets_)
+    {
+      m_dbtb_oparg_sets = dbtb_oparg_sets_;
+      return *this;
+    }
+    self_type& dbtb_oparg_ways(std::size_t dbtb_oparg_ways_)
+    {
+      m_dbtb_oparg_ways = dbtb_oparg_ways_;
+      return *this;
+    }
+    self_type& bytecode_target_predictor(BYTECODE_TARGET_PREDICTOR bytecode_target_predictor_)
+    {
+      m_bytecode_target_predictor = bytecode_target_predictor_;
+      return *this;
+    }
+    self_type& bytecode_direction_entries(std::size_t bytecode_direction_entries_)
+    {
+      m_bytecode_direction_entries = bytecode_direction_entries_;
+      return *this;
+    }
+    self_type& bytecode_direction_history(std::size_t bytecode_direction_history_)
+    {
+      m_bytecode_direction_history = bytecode_direction_history_;
+      return *this;
+    }
+    self_type& bytecode_ras_depth(std::size_t bytecode_ras_depth_)
+    {
+      m_bytecode_ras_depth = bytecode_ras_depth_;
+      return *this;
+    }
+    self_type& bytecode_ras_overflow(RAS_OVERFLOW bytecode_ras_overflow_)
+    {
+      m_bytecode_ras_overflow = bytecode_ras_overflow_;
+      return *this;
+    }
+    self_type& fusion_entries(std::size_t fusion_entries_)
+    {
+      m_fusion_entries = fusion_entries_;
+      return *this;
+    }
+    self_type& fusion_threshold(unsigned fusion_threshold_)
+    {
+      m_fusion_threshold = fusion_threshold_;
+      return *this;
+    }
+    self_type& bytecode_loop_entries(std::size_t bytecode_loop_entries_)
+    {
+      m_bytecode_loop_entries = bytecode_loop_entries_;
+      return *this;
+    }
+    self_type& bytecode_loop_prefetch_distance(std::size_t bytecode_loop_prefetch_distance_)
+    {
+      m_bytecode_loop_prefetch_distance = bytecode_loop_prefetch_distance_;
+      return *this;
+    }
+    self_type& bytecode_l1_size(std::size_t bytecode_l1_size_)
+    {
+      m_bytecode_l1_size = bytecode_l1_size_;
+      return *this;
+    }
+    self_type& bytecode_l1_ways(std::size_t bytecode_l1_ways_)
+    {
+      m_bytecode_l1_ways = bytecode_l1_ways_;
+      return *this;
+    }
+    self_type& bytecode_l1_latency(uint64_t bytecode_l1_latency_)
+    {
+      m_bytecode_l1_latency = bytecode_l1_latency_;
+      return *this;
+    }
+    self_type& bytecode_l1_mshr_size(std::size_t bytecode_l1_mshr_size_)
+    {
+      m_bytecode_l1_mshr_size = bytecode_l1_mshr_size_;
+      return *this;
+    }
+    self_type& bytecode_context_switch(BYTECODE_CONTEXT_SWITCH bytecode_context_switch_)
+    {
+      m_bytecode_context_switch = bytecode_context_switch_;
+      return *this;
+    }
     self_type& ifetch_buffer_size(std::size_t ifetch_buffer_size_)
     {
       m_ifetch_buffer_size = ifetch_buffer_size_;
@@ -519,6 +806,11 @@ public:
       m_l1i = l1i_;
       return *this;
     }
+    self_type& l1d(CACHE* l1d_)
+    {
+      m_l1d = l1d_;
+      return *this;
+    }
     self_type& l1i_bandwidth(long int l1i_bw_)
     {
       m_l1i_bw = l1i_bw_;
@@ -560,10 +852,31 @@ public:
         SCHEDULER_SIZE(b.m_schedule_width), EXEC_WIDTH(b.m_execute_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
         BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty), DISPATCH_LATENCY(b.m_dispatch_latency), DECODE_LATENCY(b.m_decode_latency),
         SCHEDULING_LATENCY(b.m_schedule_latency), EXEC_LATENCY(b.m_execute_latency), L1I_BANDWIDTH(b.m_l1i_bw), L1D_BANDWIDTH(b.m_l1d_bw),
-        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
+        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), l1d(b.m_l1d),
+        bytecode_module(BYTECODE_BUFFER{b.m_bb_rows, b.m_bb_row_size, b.m_bb_runahead_depth, b.m_bb_runahead_confidence, b.m_bb_dual_path_confidence, b.m_bb_sectored, b.m_bb_coherence, b.m_bb_fill_width, b.m_bb_early_restart}, BYTECODE_HDBT{b.m_hdbt_sets, b.m_hdbt_ways, b.m_hdbt_replacement, b.m_hdbt_prefetch_depth},
+                        BYTECODE_BTB{b.m_dbtb_entries, b.m_dbtb_oparg_sets, b.m_dbtb_oparg_ways}, b.m_bytecode_target_predictor, BYTECODE_RAS{b.m_bytecode_ras_depth, b.m_bytecode_ras_overflow},
+                        BYTECODE_FUSION{b.m_fusion_entries, b.m_fusion_threshold}, BYTECODE_DIRECTION{b.m_bytecode_direction_entries, b.m_bytecode_direction_history},
+                        BYTECODE_LOOP{b.m_bytecode_loop_entries, b.m_bytecode_loop_prefetch_distance},
+                        BYTECODE_L1{b.m_bytecode_l1_size, b.m_bytecode_l1_ways, b.m_bytecode_l1_latency, b.m_bytecode_l1_mshr_size}, b.m_bytecode_context_switch),
+        BB_PREDECODE(b.m_bb_predecode), BB_OPERAND_HINTS(b.m_bb_operand_hints), BB_FILL_FROM(b.m_bb_fill_level),
+        module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
   {
   }
   void skip_forward(ooo_model_instr const& target_instr);
+  // Sends a BB fill to the bytecode L1, or the fill level when it misses there, false when the fill level could not take it
+  bool issue_bytecode_fetch(uint64_t bpc, uint64_t instr_id);
+  template <champsim::dispatch_mode MODE>
+  void fill_bytecode_buffer(uint64_t v_address);
+  // The bytecode the BB missed on is there, fetch goes on from it
+  void restart_bytecode_fetch();
+  void predecode_bytecode(const ooo_model_instr& instr);
+  void fetch_dual_path(uint64_t bytecode_pc, int opcode, int oparg, uint64_t predicted_next_bpc, uint64_t instr_id);
+  void runahead_bytecode_fetch(uint64_t bytecode_pc, uint64_t predicted_next_bpc, uint64_t instr_id);
+  void prefetch_next_handler(uint64_t predicted_next_bpc);
+  void prefetch_loop_exit(uint64_t exit_bpc, uint64_t instr_id);
+  void hint_operand_prefetch(uint64_t bytecode_pc, int opcode, int oparg, uint64_t predicted_next_bpc, uint64_t instr_id);
+  // Hands the bytecodes of a BB fill to the operand prefetcher as they are decoded out of the returned block
+  void hint_filled_operands(uint64_t v_address);
   ooo_model_instr* find_skip_target(const ooo_model_instr& queue_front);
   void reorder_queues();
 };
@@ -21,7 +21,9 @@
 #include <deque>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "instruction.h"
 #include "util/detect.h"
@@ -135,6 +137,35 @@ ooo_model_instr bulk_tracereader<T, F>::operator()()
   return retval;
 }
 
+/*
+ * Interleaves several traces on one core, the way an OS schedules the threads of one process on it. A trace
+ * runs for a quantum of instructions and is switched out at its next bytecode load, so that no bytecode is
+ * split between two time slices, or after a second quantum if it has none. Every instruction carries the
+ * index of its trace as its ASID.
+ *
+ * The ASID only reaches the bytecode structures. Address translation stays keyed by cpu, and the TLBs and
+ * caches are not tagged, so the traces share one address space: a virtual page touched by two traces maps
+ * to the same physical page. This models threads, not separate processes.
+ */
+class multiplexed_tracereader
+{
+  std::vector<tracereader> threads;
+  std::vector<std::optional<ooo_model_instr>> held; // The instruction a trace was switched out at
+  uint64_t quantum;
+  std::size_t current = 0;
+  uint64_t executed = 0;
+
+  bool exhausted(std::size_t thread) const { return !held.at(thread).has_value() && threads.at(thread).eof(); }
+  void next_thread();
+  ooo_model_instr take();
+
+public:
+  multiplexed_tracereader(std::vector<tracereader>&& traces, uint64_t quantum_instrs);
+
+  ooo_model_instr operator()();
+  bool eof() const;
+};
+
 std::string get_fptr_cmd(std::string_view fname);
 } // namespace champsim
 
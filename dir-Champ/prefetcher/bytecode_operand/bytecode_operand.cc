@@ -0,0 +1,220 @@
+/*
+ * Operand data prefetcher for bytecode interpreters.
+ *
+ * The first data load of a LOAD_FAST, LOAD_CONST or LOAD_GLOBAL handler reads
+ * a fastlocal, a co_consts entry or a globals dict slot, at an address that is
+ * a simple function of the frame and the oparg. For every (opcode, oparg) this
+ * prefetcher learns the delta from two bases to the handler's first data load:
+ * the frame base, recovered from the fastlocal LOAD_FAST reads, and the BPC.
+ * It prefetches along the more confident one when the core hands it the
+ * bytecode, which it does with bytecode_buffer.operand_hints set. The core
+ * hands over every bytecode it decodes out of a BB row as the row fills, well
+ * before the handler runs, and again at the bytecode's BLW, which is what the
+ * loads are attributed to.
+ *
+ * Deltas are between virtual addresses, so the L1D needs virtual_prefetch.
+ */
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <fmt/core.h>
+
+#include "bytecode_opcodes.h"
+#include "cache.h"
+#include "msl/lru_table.h"
+
+namespace
+{
+constexpr uint64_t FASTLOCAL_SIZE = 8; // localsplus holds a PyObject* per local
+constexpr std::size_t NUM_OPCODES = 256;
+constexpr std::size_t MAX_WINDOWS = 32; // Bytecodes handed over whose first load has not been seen yet
+constexpr std::size_t MAX_HINTS = 32;   // Bytecodes handed over ahead of their BLW, with the block prefetched for them
+constexpr int MAX_CONFIDENCE = 3;
+constexpr int PREFETCH_CONFIDENCE = 2;
+
+struct opcode_stats {
+  uint64_t bytecodes = 0;
+  uint64_t first_loads = 0;
+  uint64_t prefetches = 0;
+  uint64_t covered = 0;
+  uint64_t covered_ahead = 0; // Covered by a prefetch issued before the bytecode's BLW
+};
+
+struct operand_prefetcher {
+  struct entry {
+    uint64_t key = 0; // opcode in the low byte, oparg above it
+    int64_t frame_delta = 0;
+    int64_t bpc_delta = 0;
+    int frame_confidence = 0;
+    int bpc_confidence = 0;
+
+    auto index() const { return key ^ (key >> 8) ^ (key >> 16); }
+    auto tag() const { return key; }
+  };
+
+  // The handler of a bytecode runs between its BLW and the next one, its loads carry the instr_ids in between
+  struct window {
+    uint64_t instr_id = 0;
+    uint64_t bpc = 0;
+    int opcode = 0;
+    int oparg = 0;
+    uint64_t prefetched_block = 0;
+    bool ahead = false;
+    bool done = false;
+  };
+
+  constexpr static std::size_t TABLE_SETS = 256;
+  constexpr static std::size_t TABLE_WAYS = 4;
+
+  champsim::msl::lru_table<entry> table{TABLE_SETS, TABLE_WAYS};
+  std::deque<window> windows;
+  uint64_t frame_base = 0;
+  // Blocks prefetched for bytecodes handed over ahead of their BLW, so they are not issued again when it arrives
+  std::deque<std::pair<uint64_t, uint64_t>> hints;
+  std::array<opcode_stats, NUM_OPCODES> stats = {};
+
+  static uint64_t key(int opcode, int oparg) { return (static_cast<uint64_t>(oparg) << 8) | static_cast<uint64_t>(opcode); }
+  static bool same_block(uint64_t a, uint64_t b) { return (a >> LOG2_BLOCK_SIZE) == (b >> LOG2_BLOCK_SIZE); }
+
+  static void train(int64_t& delta, int& confidence, uint64_t base, uint64_t addr)
+  {
+    if (base != 0 && same_block(static_cast<uint64_t>(static_cast<int64_t>(base) + delta), addr)) {
+      confidence = std::min(confidence + 1, MAX_CONFIDENCE);
+    } else if (confidence > 0) {
+      confidence--;
+    } else {
+      delta = static_cast<int64_t>(addr) - static_cast<int64_t>(base);
+    }
+  }
+
+  // Address the handler's first load is predicted at, 0 when neither base is confident
+  uint64_t predict(int opcode, int oparg, uint64_t bpc)
+  {
+    auto found = table.check_hit({key(opcode, oparg)});
+    if (!found.has_value())
+      return 0;
+    if (frame_base != 0 && found->frame_confidence >= PREFETCH_CONFIDENCE && found->frame_confidence >= found->bpc_confidence)
+      return static_cast<uint64_t>(static_cast<int64_t>(frame_base) + found->frame_delta);
+    if (found->bpc_confidence >= PREFETCH_CONFIDENCE)
+      return static_cast<uint64_t>(static_cast<int64_t>(bpc) + found->bpc_delta);
+    return 0;
+  }
+
+  void bytecode(CACHE* cache, uint64_t bpc, uint64_t instr_id, uint32_t metadata)
+  {
+    int opcode = static_cast<int>(metadata & 0xFF);
+    int oparg = static_cast<int>((metadata >> 8) & champsim::bitmask(BYTECODE_HINT_OPARG_BITS));
+    bool is_lookahead = (metadata & BYTECODE_HINT_LOOKAHEAD) != 0;
+
+    if (!is_lookahead)
+      stats[static_cast<std::size_t>(opcode)].bytecodes++;
+    auto hint = std::find_if(std::rbegin(hints), std::rend(hints), [bpc](const auto& h) { return h.first == bpc; });
+    uint64_t prefetched_block = (hint != std::rend(hints)) ? hint->second : 0;
+    bool ahead = (prefetched_block != 0);
+
+    auto pf_addr = predict(opcode, oparg, bpc);
+    if (pf_addr != 0 && !(prefetched_block != 0 && same_block(pf_addr, prefetched_block))) {
+      if (cache->prefetch_line(pf_addr, true, LOAD_TYPE::STANDARD_DATA, 0)) {
+        stats[static_cast<std::size_t>(opcode)].prefetches++;
+        prefetched_block = pf_addr;
+        ahead = is_lookahead;
+      }
+    }
+
+    if (is_lookahead) {
+      if (hint != std::rend(hints)) {
+        hint->second = prefetched_block;
+      } else if (prefetched_block != 0) {
+        hints.emplace_back(bpc, prefetched_block);
+        if (std::size(hints) > MAX_HINTS)
+          hints.pop_front();
+      }
+      return;
+    }
+    if (hint != std::rend(hints))
+      hints.erase(std::next(hint).base());
+    windows.push_back({instr_id, bpc, opcode, oparg, prefetched_block, ahead, false});
+    if (std::size(windows) > MAX_WINDOWS)
+      windows.pop_front();
+  }
+
+  void load(uint64_t addr, uint64_t instr_id)
+  {
+    // The latest bytecode handed over before this load is the one whose handler issued it
+    auto owner = std::find_if(std::rbegin(windows), std::rend(windows), [instr_id](const window& w) { return w.instr_id < instr_id; });
+    if (owner == std::rend(windows) || owner->done)
+      return;
+    owner->done = true;
+
+    auto& opcode_stat = stats[static_cast<std::size_t>(owner->opcode)];
+    opcode_stat.first_loads++;
+    if (owner->prefetched_block != 0 && same_block(owner->prefetched_block, addr)) {
+      opcode_stat.covered++;
+      if (owner->ahead)
+        opcode_stat.covered_ahead++;
+    }
+
+    // The first load of a LOAD_FAST gives away the frame base
+    if (owner->opcode == bytecode_opcode::LOAD_FAST)
+      frame_base = addr - FASTLOCAL_SIZE * static_cast<uint64_t>(owner->oparg);
+
+    auto found = table.check_hit({key(owner->opcode, owner->oparg)});
+    auto learnt = found.value_or(entry{key(owner->opcode, owner->oparg)});
+    train(learnt.frame_delta, learnt.frame_confidence, frame_base, addr);
+    train(learnt.bpc_delta, learnt.bpc_confidence, owner->bpc, addr);
+    table.fill(learnt);
+
+    // Loads issue out of order, an older window may still see its first load after this one. Only the windows that
+    // are done at the front go
+    while (!std::empty(windows) && windows.front().done)
+      windows.pop_front();
+  }
+};
+
+std::map<CACHE*, operand_prefetcher> prefetchers;
+} // namespace
+
+void CACHE::prefetcher_initialize()
+{
+  if (!virtual_prefetch) {
+    fmt::print(stderr, "[{}] The bytecode operand prefetcher learns virtual address deltas, set virtual_prefetch\n", NAME);
+    exit(1);
+  }
+  ::prefetchers[this] = {};
+}
+
+uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint64_t instr_id, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint8_t ld_type,
+                                         uint32_t metadata_in)
+{
+  auto& prefetcher = ::prefetchers[this];
+  // BB fills routed through the L1D are BLW accesses too, but carry no hint
+  if (ld_type == champsim::to_underlying(LOAD_TYPE::BLW) && (metadata_in & BYTECODE_HINT_VALID) != 0)
+    prefetcher.bytecode(this, addr, instr_id, metadata_in);
+  else if (ld_type == champsim::to_underlying(LOAD_TYPE::STANDARD_DATA) && type == champsim::to_underlying(access_type::LOAD))
+    prefetcher.load(addr, instr_id);
+  return metadata_in;
+}
+
+uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
+{
+  return metadata_in;
+}
+
+void CACHE::prefetcher_cycle_operate() {}
+
+void CACHE::prefetcher_final_stats()
+{
+  fmt::print("{} bytecode operand prefetcher, coverage by opcode\n", NAME);
+  for (std::size_t opcode = 0; opcode < NUM_OPCODES; opcode++) {
+    auto const& stat = ::prefetchers[this].stats[opcode];
+    if (stat.bytecodes == 0)
+      continue;
+    fmt::print("  opcode {:3} bytecodes: {} first loads: {} prefetches: {} covered: {} covered ahead of the BLW: {} coverage: {:.2f}%\n", opcode,
+               stat.bytecodes, stat.first_loads, stat.prefetches, stat.covered, stat.covered_ahead,
+               stat.first_loads == 0 ? 0.0 : 100.0 * static_cast<double>(stat.covered) / static_cast<double>(stat.first_loads));
+  }
+}
+
+void CACHE::prefetcher_squash(uint64_t ip, uint64_t instr_id) {}
@@ -0,0 +1,253 @@
+/*
+ * DRRIP that protects the lines a bytecode interpreter keeps coming back to.
+ *
+ * Bytecode (BLW) and dispatch table (BTG) fills, and instruction lines whose
+ * block has been re-referenced before, are inserted at RRPV 0 instead of the
+ * DRRIP insertion position. Instruction lines are told apart by the fill's ip
+ * falling in the filled block. Their reuse is learnt per block address with
+ * saturating counters, trained up on hits and down on evictions without one.
+ *
+ * Protection is set-dueled against plain DRRIP, so a phase where protected
+ * lines only take room from the data falls back to the baseline. The SRRIP/BIP
+ * duel of DRRIP runs on its own leader sets alongside.
+ *
+ * Evictions are counted by the ld_type of the fill that brought the victim in.
+ * The set ages and the eviction is counted when the fill into the victim
+ * happens, a fill the cache retries asks for its victim again.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <map>
+#include <vector>
+#include <fmt/core.h>
+
+#include "cache.h"
+#include "msl/fwcounter.h"
+
+namespace
+{
+constexpr unsigned maxRRPV = 3;
+constexpr std::size_t SDM_SIZE = 32;
+constexpr unsigned BIP_MAX = 32;
+constexpr unsigned PSEL_WIDTH = 10;
+
+constexpr std::size_t REUSE_TABLE_SIZE = 4096;
+constexpr unsigned REUSE_MAX = 3;
+constexpr unsigned REUSE_THRESHOLD = 2;
+
+// The first two duel SRRIP against BIP, the last two plain DRRIP against DRRIP with protection
+enum class leader { SRRIP, BIP, BASELINE, PROTECT, NUM_POLICY, FOLLOWER = NUM_POLICY };
+constexpr auto NUM_POLICY = static_cast<std::size_t>(leader::NUM_POLICY);
+constexpr std::size_t NUM_LOAD_TYPES = std::size(load_type_names);
+
+struct line_state {
+  unsigned rrpv = maxRRPV;
+  bool instruction = false;
+  bool reused = false;
+  bool protect = false;
+  bool victim = false; // Chosen by find_victim, the fill that replaces it has not happened yet
+  std::size_t reuse_slot = 0;
+  std::size_t ld_type = 0;
+};
+
+struct set_role {
+  leader policy = leader::FOLLOWER;
+  uint32_t cpu = 0;
+};
+
+struct bytecode_rrip {
+  std::vector<line_state> lines;
+  std::vector<set_role> roles;
+  std::array<unsigned, REUSE_TABLE_SIZE> reuse = {};
+  unsigned bip_counter = 0;
+
+  std::array<champsim::msl::fwcounter<PSEL_WIDTH>, NUM_CPUS> insert_psel = {};
+  std::array<champsim::msl::fwcounter<PSEL_WIDTH>, NUM_CPUS> protect_psel = {};
+
+  std::array<uint64_t, NUM_LOAD_TYPES> evictions = {};
+  std::array<uint64_t, NUM_LOAD_TYPES> protected_evictions = {};
+  uint64_t fills = 0;
+  uint64_t protected_fills = 0;
+
+  static std::size_t reuse_index(uint64_t v_address)
+  {
+    auto block = v_address >> LOG2_BLOCK_SIZE;
+    return (block ^ (block >> 12)) % REUSE_TABLE_SIZE;
+  }
+
+  static bool half_over(champsim::msl::fwcounter<PSEL_WIDTH> selector) { return selector.value() > (selector.maximum / 2); }
+
+  void evict(uint32_t set, uint32_t way, uint32_t num_way);
+
+  unsigned bip_rrpv()
+  {
+    if (++bip_counter == BIP_MAX) {
+      bip_counter = 0;
+      return maxRRPV - 1;
+    }
+    return maxRRPV;
+  }
+};
+
+void bytecode_rrip::evict(uint32_t set, uint32_t way, uint32_t num_way)
+{
+  auto begin = std::next(std::begin(lines), set * num_way);
+  auto end = std::next(begin, num_way);
+  auto& victim = *std::next(begin, way);
+  victim.victim = false;
+
+  // Age the set until the victim is at maxRRPV
+  auto age = maxRRPV - victim.rrpv;
+  for (auto it = begin; it != end; ++it)
+    it->rrpv = std::min(it->rrpv + age, maxRRPV);
+
+  // Instruction lines evicted before any reuse count against their block
+  if (victim.instruction && !victim.reused && reuse[victim.reuse_slot] > 0)
+    reuse[victim.reuse_slot]--;
+
+  evictions[victim.ld_type]++;
+  if (victim.protect)
+    protected_evictions[victim.ld_type]++;
+}
+
+std::map<CACHE*, bytecode_rrip> replacers;
+} // namespace
+
+void CACHE::initialize_replacement()
+{
+  // A cache built where an earlier one was must not inherit its state
+  auto& replacer = ::replacers[this];
+  replacer = {};
+  replacer.lines.resize(NUM_SET * NUM_WAY);
+  replacer.roles.resize(NUM_SET);
+
+  // randomly selected leader sets, leaving at least half of the sets to follow
+  auto sdm_size = std::min(::SDM_SIZE, NUM_SET / (2 * ::NUM_POLICY * NUM_CPUS));
+  std::size_t rand_seed = 1103515245 + 12345;
+  for (std::size_t i = 0; i < sdm_size * ::NUM_POLICY * NUM_CPUS; i++) {
+    std::size_t val = (rand_seed / 65536) % NUM_SET;
+    while (replacer.roles[val].policy != ::leader::FOLLOWER) {
+      rand_seed = rand_seed * 1103515245 + 12345;
+      val = (rand_seed / 65536) % NUM_SET;
+    }
+
+    replacer.roles[val] = {static_cast<::leader>(i % ::NUM_POLICY), static_cast<uint32_t>((i / ::NUM_POLICY) % NUM_CPUS)};
+  }
+}
+
+// called on every cache hit and cache fill
+void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                     uint8_t hit)
+{
+  auto& replacer = ::replacers[this];
+  auto& line = replacer.lines[set * NUM_WAY + way];
+  const auto& filled = block[set * NUM_WAY + way];
+
+  if (!hit && line.victim)
+    replacer.evict(set, way, NUM_WAY);
+
+  // do not update replacement state for writebacks
+  if (access_type{type} == access_type::WRITE) {
+    if (!hit) {
+      line = {::maxRRPV - 1};
+      line.reuse_slot = replacer.reuse_index(filled.v_address);
+      line.ld_type = std::min<std::size_t>(champsim::to_underlying(filled.ld_type), ::NUM_LOAD_TYPES - 1);
+    }
+    return;
+  }
+
+  // cache hit
+  if (hit) {
+    line.rrpv = 0;
+    if (line.instruction && !line.reused)
+      replacer.reuse[line.reuse_slot] = std::min(replacer.reuse[line.reuse_slot] + 1, ::REUSE_MAX);
+    line.reused = true;
+    return;
+  }
+
+  // cache miss
+  line = {};
+  line.reuse_slot = replacer.reuse_index(filled.v_address);
+  line.ld_type = std::min<std::size_t>(champsim::to_underlying(filled.ld_type), ::NUM_LOAD_TYPES - 1);
+  line.instruction = (ip != 0) && (ip >> LOG2_BLOCK_SIZE) == (filled.v_address >> LOG2_BLOCK_SIZE);
+  line.protect = filled.bytecode || (line.instruction && replacer.reuse[line.reuse_slot] >= ::REUSE_THRESHOLD);
+
+  auto role = replacer.roles[set];
+  auto& insert_psel = replacer.insert_psel[triggering_cpu];
+  auto& protect_psel = replacer.protect_psel[triggering_cpu];
+  if (role.cpu != triggering_cpu)
+    role.policy = ::leader::FOLLOWER;
+
+  // Leaders of one duel follow the winner of the other
+  bool use_bip = replacer.half_over(insert_psel);
+  bool use_protect = replacer.half_over(protect_psel);
+  switch (role.policy) {
+  case ::leader::SRRIP:
+    insert_psel++;
+    use_bip = false;
+    break;
+  case ::leader::BIP:
+    insert_psel--;
+    use_bip = true;
+    break;
+  case ::leader::BASELINE:
+    protect_psel++;
+    use_protect = false;
+    break;
+  case ::leader::PROTECT:
+    protect_psel--;
+    use_protect = true;
+    break;
+  default:
+    break;
+  }
+
+  line.protect = line.protect && use_protect;
+  if (line.protect)
+    line.rrpv = 0;
+  else if (use_bip)
+    line.rrpv = replacer.bip_rrpv();
+  else
+    line.rrpv = ::maxRRPV - 1;
+
+  replacer.fills++;
+  if (line.protect)
+    replacer.protected_fills++;
+}
+
+// find replacement victim
+uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+  auto& replacer = ::replacers[this];
+
+  // look for the maxRRPV line
+  auto begin = std::next(std::begin(replacer.lines), set * NUM_WAY);
+  auto end = std::next(begin, NUM_WAY);
+
+  auto victim = std::max_element(begin, end, [](const auto& x, const auto& y) { return x.rrpv < y.rrpv; });
+  assert(begin <= victim);
+  assert(victim < end);
+  victim->victim = true;
+
+  return static_cast<uint32_t>(std::distance(begin, victim)); // cast protected by assertions
+}
+
+// use this function to print out your own stats at the end of simulation
+void CACHE::replacement_final_stats()
+{
+  auto& replacer = ::replacers[this];
+  fmt::print("{} bytecode RRIP fills: {} protected: {} ({:.2f}%)\n", NAME, replacer.fills, replacer.protected_fills,
+             replacer.fills == 0 ? 0.0 : 100.0 * static_cast<double>(replacer.protected_fills) / static_cast<double>(replacer.fills));
+  for (uint32_t i = 0; i < NUM_CPUS; i++)
+    fmt::print("  cpu{} insertion: {} protection: {}\n", i, replacer.half_over(replacer.insert_psel[i]) ? "BIP" : "SRRIP",
+               replacer.half_over(replacer.protect_psel[i]) ? "on" : "off");
+
+  fmt::print("{} bytecode RRIP evictions by load type\n", NAME);
+  for (std::size_t i = 0; i < ::NUM_LOAD_TYPES; i++) {
+    if (replacer.evictions[i] == 0)
+      continue;
+    fmt::print("  {:19} evictions: {} of protected lines: {}\n", load_type_names[i], replacer.evictions[i], replacer.protected_evictions[i]);
+  }
+}
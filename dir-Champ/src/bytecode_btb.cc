@@ -1,257 +1,348 @@
-
 /*
- * This file implements a basic Branch Target Buffer (BTB) structure.
- * It uses a set-associative BTB to predict the targets of non-return branches,
- * and it uses a small Return Address Stack (RAS) to predict the target of
- * returns.
+ * This file implements the bytecode BTB (DBTB). It predicts the jump a
+ * bytecode makes in the bytecode stream, keyed on its opcode and, optionally,
+ * in a second level on its opcode and oparg. Every core has its own table as
+ * part of its BYTECODE_MODULE.
  */
 
 #include <algorithm>
-#include <bitset>
-#include <deque>
-#include <iostream>
-#include <map>
-#include <sstream>
+#include <tuple>
 
 #include "bytecode_module.h"
-#include "msl/lru_table.h"
-#include <fmt/ostream.h>
 
 namespace
 {
 
-constexpr bool USE_OPARGS = false;
 constexpr int MAX_USAGE_VAL = 8;
-constexpr std::size_t STARTING_USAGE_VAL = 4;
+constexpr int STARTING_USAGE_VAL = 4;
 constexpr int MAX_CONFIDENCE = 3;
 constexpr int STARTING_CONFIDENCE = 3;
 
-std::map<int, btb_entry_stats> entryStats = {};
+DBTB_SUB_ENTRY newSubEntry(int oparg, int64_t jump)
+{
+  DBTB_SUB_ENTRY entry;
+  entry.jump = jump;
+  entry.oparg = oparg;
+  entry.usage = STARTING_USAGE_VAL;
+  entry.confidence = STARTING_CONFIDENCE;
+  entry.valid = true;
+  entry.allocated = true;
+  return entry;
+}
 
-struct btb_entry_t {
-  int opcode = 0;
-  int oparg = 0;
-  int64_t jump = 0;
-  bool valid = true;
-  bool inner_entry = false;
-  std::vector<btb_entry_t> inner_entries;
+double percentage(uint64_t hits, uint64_t misses) { return 100 * (double)hits / ((double)hits + (double)misses); }
 
-  int usage = STARTING_USAGE_VAL;
-  int confidence = STARTING_CONFIDENCE;
-  uint64_t lru = STARTING_BBTB_LRU_VAL;
+// No prediction means the next bytecode
+bool jumpMatches(int64_t predicted, int64_t correct) { return predicted == correct || (predicted == 0 && correct == BYTECODE_SIZE); }
 
-  uint64_t hits{0}, misses{0};
+} // namespace
 
-  void update(int64_t correctJump)
-  {
-    if (valid == false)
-      return;
-    if (jump == 0) {
-      jump = correctJump;
-      return;
-    }
-    if (correctJump == jump) {
-      correctPrediction();
-    } else {
-      wrongPrediction(correctJump);
-    }
+void DBTB_SUB_ENTRY::update(int64_t correctJump, btb_entry_stats& entryCounters, btb_entry_stats& opcodeCounters)
+{
+  if (valid == false)
+    return;
+  if (jump == 0) {
+    jump = correctJump;
+    return;
   }
-
-  void correctPrediction()
-  {
+  if (correctJump == jump) {
     if (confidence < MAX_CONFIDENCE)
       confidence++;
     if (usage < MAX_USAGE_VAL)
       usage++;
-    hits++;
-    entryStats[opcode].hit++;
-  }
-
-  void wrongPrediction(int64_t correctTarget)
-  {
+    entryCounters.hit++;
+    opcodeCounters.hit++;
+  } else {
     if (confidence > 1)
       confidence--;
     else {
       confidence = STARTING_CONFIDENCE;
-      jump = correctTarget;
+      jump = correctJump;
     }
     if (usage > 0)
       usage--;
     else
       valid = false;
-    misses++;
-    entryStats[opcode].miss++;
-  }
-
-  btb_entry_t* findInnerEntry(int oparg)
-  {
-    if constexpr (!USE_OPARGS)
-      return this;
-    if (oparg == 0)
-      return this;
-    auto entry = std::find_if(inner_entries.begin(), inner_entries.end(), [oparg](btb_entry_t btb_entry) { return btb_entry.oparg == oparg; });
-    if (entry == inner_entries.end())
-      return nullptr;
-    return &(*entry);
-  }
-
-  int64_t makePrediction(int oparg)
-  {
-    auto innerEntry = findInnerEntry(oparg);
-    if (innerEntry == nullptr) {
-      return (valid) ? jump : 0;
-    }
-    return (innerEntry->valid) ? innerEntry->jump : 0;
+    entryCounters.miss++;
+    opcodeCounters.miss++;
   }
+}
 
-  auto totalHitsAndMisses() const
-  {
-    uint64_t totalHits = hits;
-    uint64_t totalMisses = misses;
-    for (auto const& innerEntry : inner_entries) {
-      totalHits += innerEntry.hits;
-      totalMisses += innerEntry.misses;
-    }
-    return std::pair(totalHits, totalMisses);
+BYTECODE_BTB::BYTECODE_BTB(std::size_t entries, std::size_t oparg_sets_, std::size_t oparg_ways_)
+    : capacity(entries), oparg_sets(oparg_sets_), oparg_ways(oparg_ways_), oparg_set_bits(champsim::lg2(oparg_sets_)),
+      oparg_table(oparg_sets_ * oparg_ways_)
+{
+  if (capacity > DBTB_NUM_OPCODES) {
+    fmt::print(stderr, "[BYTECODE BTB] Holds at most one entry per opcode ({}), got entries: {}\n", DBTB_NUM_OPCODES, capacity);
+    exit(1);
   }
-
-  double percentageHits() const
-  {
-    if (inner_entry)
-      return 0;
-    auto [totalHits, totalMisses] = totalHitsAndMisses();
-    return 100 * (double)totalHits / ((double)totalHits + (double)totalMisses);
+  if ((oparg_sets & (oparg_sets - 1)) != 0 || (oparg_sets > 0 && oparg_ways == 0)) {
+    fmt::print(stderr, "[BYTECODE BTB] Needs a power of two number of oparg sets and at least one way, got sets: {} ways: {}\n", oparg_sets, oparg_ways);
+    exit(1);
   }
-};
-
-std::vector<btb_entry_t> bytecode_BTB;
-/*
- * The following structure identifies the size of call instructions so we can
- * find the target for a call's return, since calls may have different sizes.
- */
-} // namespace
+}
 
-btb_entry_t* findOuterEntry(int opcode)
+std::size_t BYTECODE_BTB::opargSet(int opcode, int oparg) const
 {
-  auto entry = std::find_if(bytecode_BTB.begin(), bytecode_BTB.end(), [opcode](btb_entry_t entry) { return entry.opcode == opcode; });
-  if (entry != bytecode_BTB.end())
-    return &(*entry);
-  return nullptr;
+  auto hash = (static_cast<uint64_t>(static_cast<uint32_t>(oparg)) * 0x9E3779B97F4A7C15ull) >> 32;
+  return static_cast<std::size_t>((hash ^ static_cast<uint64_t>(slot(opcode))) & (oparg_sets - 1));
 }
 
-btb_entry_t* createOuterEntry(int opcode)
+DBTB_OPARG_ENTRY* BYTECODE_BTB::findOpargEntry(int opcode, int oparg)
 {
-  btb_entry_t newEntry;
-  newEntry.opcode = opcode;
-  bytecode_BTB.emplace_back(newEntry);
-  return &bytecode_BTB.back();
+  auto set_begin = std::next(std::begin(oparg_table), static_cast<long>(opargSet(opcode, oparg) * oparg_ways));
+  auto set_end = std::next(set_begin, static_cast<long>(oparg_ways));
+  auto found = std::find_if(set_begin, set_end, [this, opcode, oparg](const DBTB_OPARG_ENTRY& entry) {
+    return entry.sub.valid && entry.opcode == opcode && entry.sub.oparg == oparg && entry.asid == current_asid;
+  });
+  return found == set_end ? nullptr : &(*found);
 }
 
-void updateLRUs() {
-  for (auto &elem : bytecode_BTB) {
-    elem.lru--;
+void BYTECODE_BTB::updateOparg(const DBTB_ENTRY& entry, int opcode, int oparg, int64_t correct_jump)
+{
+  int64_t opcode_only = (entry.outer.valid && entry.asid == current_asid) ? entry.outer.jump : 0;
+  auto second = findOpargEntry(opcode, oparg);
+  oparg_stats.lookups++;
+  oparg_stats.opcode_only_correct += jumpMatches(opcode_only, correct_jump);
+  oparg_stats.correct += jumpMatches(second != nullptr ? second->sub.jump : opcode_only, correct_jump);
+
+  if (second != nullptr) {
+    oparg_stats.hits++;
+    // The per opcode counters follow the first level
+    btb_entry_stats entry_counter{}, opcode_counter{};
+    second->sub.update(correct_jump, entry_counter, opcode_counter);
+    second->lru = ++access_counter;
+    return;
   }
+  // Only pairs the opcode alone gets wrong are worth an entry
+  if (jumpMatches(opcode_only, correct_jump))
+    return;
+
+  auto set_begin = std::next(std::begin(oparg_table), static_cast<long>(opargSet(opcode, oparg) * oparg_ways));
+  auto set_end = std::next(set_begin, static_cast<long>(oparg_ways));
+  auto victim = std::min_element(set_begin, set_end, [](const DBTB_OPARG_ENTRY& a, const DBTB_OPARG_ENTRY& b) {
+    return std::tie(a.sub.valid, a.lru) < std::tie(b.sub.valid, b.lru);
+  });
+  if (victim->sub.valid)
+    oparg_stats.evictions++;
+  oparg_stats.allocations++;
+  *victim = DBTB_OPARG_ENTRY{newSubEntry(oparg, correct_jump), opcode, ++access_counter, current_asid};
 }
 
-bool foundVictim()
+bool BYTECODE_BTB::foundVictim()
 {
-  if (bytecode_BTB.size() < BYTECODE_BTB_SIZE) {
+  if (allocated_entries < capacity) {
     return true;
   }
-  if constexpr (BYTECODE_BTB_SIZE == 0)
+  if (capacity == 0)
     return false;
-  auto victim = bytecode_BTB.front();
-  for (auto& entry : bytecode_BTB) {
-    if (entry.valid && (entry.lru < victim.lru)) {
-      victim = entry;
+
+  DBTB_ENTRY* victim = nullptr;
+  for (auto& entry : table) {
+    if (entry.outer.allocated && (victim == nullptr || entry.lru < victim->lru)) {
+      victim = &entry;
     }
   }
-  bytecode_BTB.erase(std::find_if(bytecode_BTB.begin(), bytecode_BTB.end(), [victim] (btb_entry_t entry) { return entry.opcode == victim.opcode; }));
+  auto victim_slot = static_cast<std::size_t>(std::distance(std::begin(table), victim));
+  *victim = DBTB_ENTRY{};
+  entry_counters[victim_slot] = {};
+  allocated_entries--;
   return true;
 }
 
-int64_t BYTECODE_MODULE::btb_prediction(int opcode, int oparg)
+int64_t BYTECODE_BTB::prediction(int opcode, int oparg) { return predictionWithConfidence(opcode, oparg).first; }
+
+std::pair<int64_t, int> BYTECODE_BTB::predictionWithConfidence(int opcode, int oparg)
 {
-  if (findOuterEntry(opcode) == nullptr)
-    return 0;
-  return findOuterEntry(opcode)->makePrediction(oparg);
+  if (opargsEnabled()) {
+    auto second = findOpargEntry(opcode, oparg);
+    if (second != nullptr)
+      return {second->sub.jump, second->sub.confidence};
+  }
+  auto& entry = table[slot(opcode)];
+  if (!entry.outer.allocated || entry.asid != current_asid)
+    return {0, MAX_CONFIDENCE};
+  if (!entry.outer.valid)
+    return {0, 0};
+  return {entry.outer.jump, entry.outer.confidence};
 }
 
-void BYTECODE_MODULE::update_btb(int opcode, int oparg, int64_t correct_jump)
+void BYTECODE_BTB::update(int opcode, int oparg, int64_t correct_jump)
 {
-  auto outerEntry = findOuterEntry(opcode);
-  if (correct_jump > 16) {
-    stats.very_large_jumps++;
-  }
-  else if (correct_jump > 4) {
-    stats.large_jumps++;
-  } else {
-    stats.small_jumps++;
+  auto& entry = table[slot(opcode)];
+  auto& counters = entry_counters[slot(opcode)];
+  if (entry.outer.allocated && entry.asid != current_asid) {
+    slot_conflicts++;
+    entry = DBTB_ENTRY{};
+    counters = {};
+    allocated_entries--;
   }
-
-  
-  if (outerEntry == nullptr) {
+  if (opargsEnabled())
+    updateOparg(entry, opcode, oparg, correct_jump);
+  if (!entry.outer.allocated) {
     // No point in creating entries for standard bytecodes
     if (correct_jump == BYTECODE_SIZE)
       return;
     if (!foundVictim())
       return;
-    outerEntry = createOuterEntry(opcode);
-  }
-  auto innerEntry = outerEntry->findInnerEntry(oparg);
-  if (innerEntry == nullptr) {
-    if (correct_jump != outerEntry->jump) {
-      btb_entry_t newEntry;
-      newEntry.opcode = opcode;
-      newEntry.oparg = oparg;
-      newEntry.jump = correct_jump;
-      outerEntry->inner_entries.emplace_back(newEntry);
-    }
-    outerEntry->update(correct_jump);
-    updateLRUs();
-    outerEntry->lru++;
-  } else {
-    innerEntry->update(correct_jump);
-    updateLRUs();
-    innerEntry->lru++;
+    entry.outer = newSubEntry(0, 0);
+    entry.asid = current_asid;
+    entry.opcode = static_cast<uint8_t>(opcodeIndex(opcode));
+    allocated_entries++;
   }
+
+  // The first level trains on every update, so it stays the opcode-only prediction the second level is scored against
+  entry.outer.update(correct_jump, counters, opcode_counters[opcodeIndex(opcode)]);
+  entry.lru = ++access_counter;
 }
 
-void BYTECODE_MODULE::printBTBs()
+double BYTECODE_BTB::print()
 {
-  // Iterate over each module and its corresponding INDIRECT_BTB entries
-  int moduleint = 0;
   fmt::print(stdout, "\n --- BYTECODE MODULE BTB STATS --- \n");
   uint64_t totalMisses{0}, totalHits{0};
-  for (auto const& outer_entry : bytecode_BTB) {
-    auto [hits, misses] = outer_entry.totalHitsAndMisses();
-    totalMisses += misses;
-    totalHits += hits;
+  for (auto const& counter : entry_counters) {
+    totalHits += counter.hit;
+    totalMisses += counter.miss;
   }
-  auto totalPercentage = 100 * (double)totalHits / ((double)totalHits + (double)totalMisses);
-  stats.BTB_PERCENTAGE = totalPercentage;
+  auto totalPercentage = percentage(totalHits, totalMisses);
 
   fmt::print("BYTECODE BTB HITS: {}, MISS: {}, PERCENTAGE: {} \n", totalHits, totalMisses, totalPercentage);
-  for (auto const& outer_entry : bytecode_BTB) {
-    fmt::print(stdout, "Outer entry for opcode: {}, hits: {}, misses: {}, percentage: {}, prediction: {} \n \t", outer_entry.opcode, outer_entry.hits,
-               outer_entry.misses, outer_entry.percentageHits(), outer_entry.jump);
-    for (auto const& inner_entry : outer_entry.inner_entries) {
-      fmt::print(stdout, "  [arg: {}, h: {}, m: {}, j: {}] ", inner_entry.opcode, inner_entry.hits, inner_entry.misses, inner_entry.jump);
+  for (std::size_t i = 0; i < DBTB_NUM_OPCODES; i++) {
+    auto const& entry = table[i];
+    auto const& counter = entry_counters[i];
+    if (!entry.outer.allocated)
+      continue;
+
+    fmt::print(stdout, "Outer entry for opcode: {}, ASID: {}, hits: {}, misses: {}, percentage: {}, prediction: {} \n \t", entry.opcode, entry.asid, counter.hit,
+               counter.miss, percentage(counter.hit, counter.miss), entry.outer.jump);
+    for (auto const& second : oparg_table) {
+      if (second.sub.valid && second.opcode == entry.opcode && second.asid == entry.asid)
+        fmt::print(stdout, "  [arg: {}, j: {}] ", second.sub.oparg, second.sub.jump);
     }
     fmt::print(stdout, "\n");
   }
   fmt::print(stdout, "---------------------------------- \n\n");
+  return totalPercentage;
 }
 
-void BYTECODE_MODULE::generateDBTBStats()
+void BYTECODE_BTB::generateStats(std::map<int, btb_entry_stats>& entryStats) const
+{
+  for (std::size_t opcode = 0; opcode < DBTB_NUM_OPCODES; opcode++) {
+    auto const& counter = opcode_counters[opcode];
+    if (counter.hit != 0 || counter.miss != 0)
+      entryStats[static_cast<int>(opcode)] = counter;
+  }
+}
+
+void BYTECODE_BTB::resetStats()
+{
+  opcode_counters = {};
+  oparg_stats = DBTB_OPARG_STATS{};
+  slot_conflicts = 0;
+}
+
+uint64_t BYTECODE_BTB::storageBits() const
+{
+  // valid, jump, usage and confidence per sub-entry. Every entry is tagged with its opcode and keeps an LRU
+  // rank among the allocated entries, second level entries tag the oparg bits their set does not give back.
+  uint64_t sub_entry_bits = 1 + DBTB_JUMP_BITS + 4 + 2;
+  uint64_t entry_bits = sub_entry_bits + champsim::lg2(DBTB_NUM_OPCODES) + champsim::lg2(std::max<std::size_t>(capacity, 1));
+  uint64_t oparg_entry_bits = sub_entry_bits + champsim::lg2(DBTB_NUM_OPCODES) + DBTB_OPARG_BITS - oparg_set_bits + champsim::lg2(std::max<std::size_t>(oparg_ways, 1));
+  return capacity * entry_bits + std::size(oparg_table) * oparg_entry_bits;
+}
+
+std::size_t BYTECODE_BTB::contextSwitch(uint8_t asid, bool flush)
 {
-  for (auto const& [opcode, btb_stats] : entryStats) {
-    stats.dbtb_entryStats[opcode].hit = btb_stats.hit;
-    stats.dbtb_entryStats[opcode].miss = btb_stats.miss;
+  current_asid = asid;
+  if (flush) {
+    table = {};
+    entry_counters = {};
+    allocated_entries = 0;
+    std::fill(std::begin(oparg_table), std::end(oparg_table), DBTB_OPARG_ENTRY{});
   }
+  auto first_level =
+      std::count_if(std::begin(table), std::end(table), [asid](const DBTB_ENTRY& entry) { return entry.outer.allocated && entry.asid == asid; });
+  auto second_level =
+      std::count_if(std::begin(oparg_table), std::end(oparg_table), [asid](const DBTB_OPARG_ENTRY& entry) { return entry.sub.valid && entry.asid == asid; });
+  return static_cast<std::size_t>(first_level + second_level);
 }
 
-void BYTECODE_MODULE::resetDBTBStats()
+int64_t BYTECODE_MODULE::btb_prediction(int opcode, int oparg, uint64_t bpc)
 {
-  entryStats.clear();
-}
\ No newline at end of file
+  // Conditional bytecodes only take the stored target when the direction predictor says so
+  bool direction_taken = true;
+  if (direction.enabled() && BYTECODE_DIRECTION::isConditional(opcode))
+    direction_taken = direction.predict(bpc);
+  // A loop with a stable trip count knows when it is left, it overrides the direction predictor
+  if (loop.enabled() && BYTECODE_LOOP::isLoopBranch(opcode)) {
+    auto loop_jump = loop.predict(bpc, opcode);
+    if (loop_jump != 0)
+      return loop_jump;
+  }
+  if (!direction_taken)
+    return BYTECODE_DIRECTION::fallThrough(opcode);
+  if (target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE)
+    return tage.prediction(dbtb, opcode, oparg, bpc);
+  return dbtb.prediction(opcode, oparg);
+}
+
+uint64_t BYTECODE_MODULE::targetPredictorStorageBits() const
+{
+  if (target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE)
+    return dbtb.storageBits() + tage.storageBits() + direction.storageBits() + loop.storageBits();
+  return dbtb.storageBits() + direction.storageBits() + loop.storageBits();
+}
+
+BYTECODE_STORAGE BYTECODE_MODULE::storage() const
+{
+  // Without skipping only pre-decode uses the bytecode structures. Fusion and the prefetchers only run in the
+  // full skip mode, and the decode table is only read by run-ahead, handler prefetch, operand hints and pre-decode
+  bool skip = champsim::skips_dispatch(dispatch);
+  bool helpers = (dispatch == champsim::dispatch_mode::SKIP);
+  if (!skip && !predecode_enabled)
+    return BYTECODE_STORAGE{};
+  bool decode_read = skip ? (helpers && (bb_buffer.runahead_depth > 0 || hdbt.prefetch_depth > 0 || operand_hints_enabled)) : predecode_enabled;
+  return BYTECODE_STORAGE{bb_buffer.storageBits(),
+                          hdbt.storageBits(),
+                          targetPredictorStorageBits(),
+                          ras.storageBits(),
+                          helpers ? fusion.storageBits() : 0,
+                          skip ? bytecode_l1.storageBits() : 0,
+                          decode_read ? RUNAHEAD_DECODE_SIZE * RUNAHEAD_DECODE_ENTRY_BITS : 0};
+}
+
+void BYTECODE_MODULE::update_btb(int opcode, int oparg, uint64_t bpc, int64_t correct_jump)
+{
+  if (correct_jump > 16) {
+    stats.very_large_jumps++;
+  }
+  else if (correct_jump > 4) {
+    stats.large_jumps++;
+  } else {
+    stats.small_jumps++;
+  }
+  if (loop.enabled() && BYTECODE_LOOP::isLoopBranch(opcode))
+    loop.update(bpc, opcode, correct_jump);
+  if (direction.enabled() && BYTECODE_DIRECTION::isConditional(opcode)) {
+    bool taken = (correct_jump != BYTECODE_DIRECTION::fallThrough(opcode));
+    direction.update(taken);
+    // The target store keeps the taken target, a fall-through would overwrite it
+    if (!taken)
+      return;
+  }
+  if (target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE)
+    tage.update(dbtb, opcode, oparg, bpc, correct_jump);
+  else
+    dbtb.update(opcode, oparg, correct_jump);
+}
+
+void BYTECODE_MODULE::printBTBs() { stats.BTB_PERCENTAGE = dbtb.print(); }
+
+void BYTECODE_MODULE::generateDBTBStats()
+{
+  dbtb.generateStats(stats.dbtb_entryStats);
+  stats.dbtb_oparg_stats = dbtb.oparg_stats;
+  stats.dbtb_slot_conflicts = dbtb.slot_conflicts;
+}
+
+void BYTECODE_MODULE::resetDBTBStats() { dbtb.resetStats(); }
@@ -2,18 +2,254 @@
 
 #include <algorithm>
 #include <random>
+
+BYTECODE_BUFFER::BYTECODE_BUFFER(std::size_t num_rows, uint64_t bytecodes_per_row, std::size_t runahead_depth_, int runahead_confidence_,
+                                 int dual_path_confidence_, bool sectored_rows, BB_COHERENCE coherence_policy, uint64_t fill_width_,
+                                 bool early_restart_)
+    : rows(num_rows), row_size(bytecodes_per_row), log2_row_size(champsim::lg2(bytecodes_per_row)),
+      log2_row_bytes(champsim::lg2(bytecodes_per_row * BYTECODE_SIZE)), sectored(sectored_rows),
+      granule_bits(sectored_rows ? LOG2_BLOCK_SIZE : log2_row_bytes), coherence(coherence_policy),
+      fill_width(fill_width_), early_restart(early_restart_), runahead_depth(runahead_depth_),
+      runahead_confidence(runahead_confidence_), dual_path_confidence(dual_path_confidence_)
+{
+  if (rows == 0 || rows > std::numeric_limits<uint8_t>::max() || row_size == 0 || (row_size & (row_size - 1)) != 0) {
+    fmt::print(stderr, "[BYTECODE BUFFER] Needs 1 to 255 rows and a power of two row size, got rows: {} row size: {}\n", rows, row_size);
+    exit(1);
+  }
+  if (sectored && row_size * BYTECODE_SIZE > BLOCK_SIZE) {
+    fmt::print(stderr, "[BYTECODE BUFFER] Sectored rows can not be larger than a cache block, got row size: {}\n", row_size);
+    exit(1);
+  }
+  // The slots written so far are kept in a 64 bit mask
+  if (fill_width > 0 && (sectored ? BLOCK_SIZE / BYTECODE_SIZE : row_size) > std::numeric_limits<uint64_t>::digits) {
+    fmt::print(stderr, "[BYTECODE BUFFER] A row written fill_width bytecodes at a time can hold at most {} bytecodes, got row size: {}\n",
+               std::numeric_limits<uint64_t>::digits, row_size);
+    exit(1);
+  }
+}
+
 void BYTECODE_BUFFER::initialize()
 {
-  for (uint8_t i = 0; i < static_cast<uint8_t>(BYTECODE_BUFFER_NUM); i++) {
-    buffers.push_back(BB_ENTRY{i});
+  buffers.clear();
+  for (std::size_t i = 0; i < rows; i++) {
+    buffers.push_back(BB_ENTRY{static_cast<uint8_t>(i)});
+  }
+
+  // Every row is registered in at most BB_MAX_INDEXED_BUCKETS buckets, keep the load per bucket low
+  std::size_t num_buckets = 1;
+  while (num_buckets < BB_MAX_INDEXED_BUCKETS * rows)
+    num_buckets <<= 1;
+  index.assign(num_buckets, {});
+  scratch.reserve(rows);
+}
+
+void BYTECODE_BUFFER::unindex(BB_ENTRY& entry)
+{
+  for (std::size_t i = 0; i < entry.num_indexed_buckets; i++) {
+    auto& rows_in_bucket = index[entry.indexed_buckets[i]];
+    rows_in_bucket.erase(std::remove(std::begin(rows_in_bucket), std::end(rows_in_bucket), entry.index), std::end(rows_in_bucket));
+  }
+  entry.num_indexed_buckets = 0;
+}
+
+void BYTECODE_BUFFER::reindex(BB_ENTRY& entry)
+{
+  unindex(entry);
+  // Rows of other address spaces stay out of the index, so no lookup sees them
+  if (entry.asid != current_asid)
+    return;
+
+  auto add_range = [this, &entry](uint64_t low, uint64_t high) {
+    for (auto granule = low >> granule_bits; granule <= (high >> granule_bits); granule++) {
+      auto b = bucket(granule << granule_bits);
+      auto begin = std::begin(entry.indexed_buckets);
+      auto end = std::next(begin, static_cast<long>(entry.num_indexed_buckets));
+      if (std::find(begin, end, b) == end && entry.num_indexed_buckets < BB_MAX_INDEXED_BUCKETS) {
+        entry.indexed_buckets[entry.num_indexed_buckets++] = b;
+        index[b].push_back(entry.index);
+      }
+    }
+  };
+
+  if (entry.valid)
+    add_range(entry.baseAddr, entry.maxAddr);
+  if (entry.fetching)
+    add_range(entry.fetching_base_addr, entry.fetching_max_addr);
+}
+
+void BYTECODE_BUFFER::rowsInBlock(uint64_t blockBase)
+{
+  // Collects the rows that might be fetching into the cache block, in row order
+  scratch.clear();
+  auto first = (blockBase >> LOG2_BLOCK_SIZE) << LOG2_BLOCK_SIZE;
+  auto last = first + BLOCK_SIZE - 1;
+  for (auto granule = first >> granule_bits; granule <= (last >> granule_bits); granule++) {
+    for (auto row : index[bucket(granule << granule_bits)]) {
+      if (buffers[row].inCacheBlock(blockBase) && std::find(std::begin(scratch), std::end(scratch), row) == std::end(scratch))
+        scratch.push_back(row);
+    }
+  }
+  // Rows of other address spaces are not indexed, but their fills still return into them
+  if (foreign_rows) {
+    for (auto const& entry : buffers) {
+      if (entry.asid != current_asid && entry.inCacheBlock(blockBase))
+        scratch.push_back(entry.index);
+    }
+  }
+  std::sort(std::begin(scratch), std::end(scratch));
+}
+
+void BYTECODE_BUFFER::startFetch(BB_ENTRY& entry, uint64_t baseAddr, uint64_t currentCycle)
+{
+  stopWriting(entry);
+  entry.asid = current_asid;
+  if (sectored)
+    entry.fetchBlock(baseAddr, currentCycle);
+  else
+    entry.fetch(baseAddr, currentCycle, rowSize());
+}
+
+void BYTECODE_BUFFER::validate(BB_ENTRY& entry, uint64_t currentCycle)
+{
+  // The fill covers the whole fetching range, so every sector of it becomes valid at once
+  entry.valid = true;
+  entry.fetching = false;
+  if (entry.hits_since_last_switch == 0)
+    entry.switched_with_no_hits++;
+
+  entry.hits_since_last_switch = 0;
+  entry.baseAddr = entry.fetching_base_addr;
+  entry.maxAddr = entry.fetching_max_addr;
+  entry.log2_sector_bytes = log2_row_bytes;
+  entry.valid_sectors = sectored ? champsim::bitmask(BLOCK_SIZE >> log2_row_bytes) : std::numeric_limits<uint64_t>::max();
+  entry.lru = ++access_counter;
+  reindex(entry);
+
+  // A store hit the row while its block was in flight, the stored sectors came back with their old code units
+  if (entry.stale_sectors != 0) {
+    auto stale = entry.stale_sectors;
+    entry.stale_sectors = 0;
+    invalidate(entry, stale);
+    if (!entry.valid)
+      return;
+  }
+
+  bool demand = currFetching.first && entry.asid == current_asid && entry.holds(currFetching.second);
+  if (fill_width == 0) {
+    entry.written_slots = std::numeric_limits<uint64_t>::max();
+  } else {
+    // The row is written in order from its first bytecode. With early restart the missed bytecode goes first, and
+    // the cycles it would have waited for the slots in front of it are saved
+    entry.written_slots = 0;
+    entry.write_next = (early_restart && demand) ? entry.slot(currFetching.second) : 0;
+    entry.slots_to_write = entry.slots();
+    rows_writing++;
+    if (entry.write_next > 0) {
+      stats.early_restart_saved += entry.write_next / fill_width;
+      stats.early_restarts++;
+    }
+    writeSlots(entry);
+  }
+
+  if (demand && entry.hit(currFetching.second))
+    recordMissWait(entry, currentCycle);
+}
+
+void BYTECODE_BUFFER::writeSlots(BB_ENTRY& entry)
+{
+  for (uint64_t i = 0; i < fill_width && entry.slots_to_write > 0; i++) {
+    entry.written_slots |= uint64_t{1} << entry.write_next;
+    entry.write_next = (entry.write_next + 1) % entry.slots();
+    entry.slots_to_write--;
+  }
+  if (entry.slots_to_write == 0)
+    rows_writing--;
+}
+
+void BYTECODE_BUFFER::stopWriting(BB_ENTRY& entry)
+{
+  // The slots that were not written yet are left out, a lookup misses on them and fetches them again
+  if (entry.slots_to_write > 0) {
+    entry.slots_to_write = 0;
+    rows_writing--;
   }
 }
 
+void BYTECODE_BUFFER::rewriteSlots(BB_ENTRY& entry, uint64_t first, uint64_t last)
+{
+  // The updated slots go through the fill port again. The write backs up to the first of them that was already
+  // written and goes on from there, so the slots still to be written keep their turn
+  if (fill_width == 0)
+    return;
+  while (first <= last && !((entry.written_slots >> first) & 1))
+    first++;
+  if (first > last)
+    return;
+  uint64_t backup = last + 1 - first;
+  if (entry.slots_to_write > 0)
+    backup = (entry.write_next + entry.slots() - first) % entry.slots();
+  else
+    rows_writing++;
+  for (uint64_t i = 0; i < backup; i++)
+    entry.written_slots &= ~(uint64_t{1} << ((first + i) % entry.slots()));
+  entry.write_next = first;
+  entry.slots_to_write += backup;
+}
+
+void BYTECODE_BUFFER::invalidate(BB_ENTRY& entry, uint64_t sectors)
+{
+  entry.valid_sectors &= ~sectors;
+  entry.invalidated_by_store = true;
+  stats.coherence_invalidations++;
+  if (entry.valid_sectors == 0) {
+    entry.valid = false;
+    stopWriting(entry);
+    reindex(entry);
+  }
+}
+
+bool BYTECODE_BUFFER::writeRows(uint64_t currentCycle)
+{
+  if (rows_writing == 0)
+    return false;
+
+  bool demand_written = false;
+  for (auto& entry : buffers) {
+    if (entry.slots_to_write == 0)
+      continue;
+    bool demand = currFetching.first && entry.asid == current_asid && entry.writing(currFetching.second);
+    writeSlots(entry);
+    if (demand && entry.hit(currFetching.second)) {
+      recordMissWait(entry, currentCycle);
+      demand_written = true;
+    }
+  }
+  return demand_written;
+}
+
 bool BYTECODE_BUFFER::hitInBB(uint64_t sourceMemoryAddr)
 {
   BB_ENTRY* entry = hit(sourceMemoryAddr);
   if (entry == nullptr) {
     stats.miss++;
+    // Rows a store invalidated are no longer indexed, so all of them are checked
+    for (auto& invalidated : buffers) {
+      if (invalidated.invalidated_by_store && invalidated.asid == current_asid && sourceMemoryAddr >= invalidated.baseAddr && sourceMemoryAddr <= invalidated.maxAddr) {
+        invalidated.invalidated_by_store = false;
+        stats.coherence_misses++;
+        break;
+      }
+    }
+    // A run-ahead fill that is still in flight for this address was issued too late
+    for (auto row : index[bucket(sourceMemoryAddr)]) {
+      BB_ENTRY& fetching_entry = buffers[row];
+      if (fetching_entry.runahead && !fetching_entry.runahead_used && fetching_entry.currentlyFetching(sourceMemoryAddr)) {
+        fetching_entry.runahead_used = true;
+        stats.runahead_useful++;
+        stats.runahead_late++;
+        break;
+      }
+    }
     if constexpr (BB_DEBUG_LEVEL > 2)
       fmt::print("[BYTECODE BUFFER] Missed on address {} - Total misses in BB: {} -> {}%\n", sourceMemoryAddr, stats.miss,
                  (stats.miss * 100) / (stats.miss + stats.hits));
@@ -23,8 +259,12 @@ bool BYTECODE_BUFFER::hitInBB(uint64_t sourceMemoryAddr)
   if constexpr (BB_DEBUG_LEVEL > 2)
     fmt::print("[BYTECODE BUFFER] Hit on address {} - Total hits in BB: {} -> {}%\n", sourceMemoryAddr, stats.hits,
                (stats.hits * 100) / (stats.miss + stats.hits));
-  decrementLRUs();
-  entry->lru++;
+  if (entry->runahead && !entry->runahead_used) {
+    entry->runahead_used = true;
+    stats.runahead_useful++;
+    stats.runahead_timely++;
+  }
+  entry->lru = ++access_counter;
   entry->hits++;
   entry->hits_since_last_switch++;
   return true;
@@ -32,29 +272,33 @@ bool BYTECODE_BUFFER::hitInBB(uint64_t sourceMemoryAddr)
 
 bool BYTECODE_BUFFER::shouldFetch(uint64_t baseAddr)
 {
-  for (BB_ENTRY& entry : buffers) {
+  // The first row, in row order, that holds or is fetching the address decides
+  BB_ENTRY* found = nullptr;
+  for (auto row : index[bucket(baseAddr)]) {
+    BB_ENTRY& entry = buffers[row];
     if constexpr (BB_DEBUG_LEVEL > 2)
       fmt::print("[BYTECODE BUFFER] Checking fetching on entry, fetching {}, lru {}, valid {}, baseaddr {}, maxaddr {} \n", entry.fetching, entry.lru,
                  entry.valid, entry.baseAddr, entry.maxAddr);
-    if (entry.hit(baseAddr) && entry.fetching) {
-      stats.aggressive_prefetches++;
-    }
-    if (entry.hit(baseAddr)) {
-      return false;
-    }
-    if (entry.currentlyFetching(baseAddr)) {
-      return false;
+    if ((entry.hit(baseAddr) || entry.currentlyFetching(baseAddr)) && (found == nullptr || entry.index < found->index)) {
+      found = &entry;
     }
   }
-  return true;
+  if (found == nullptr) {
+    return true;
+  }
+  if (found->hit(baseAddr) && found->fetching) {
+    stats.aggressive_prefetches++;
+  }
+  return false;
 }
 
 void BYTECODE_BUFFER::fetching(uint64_t baseAddr, uint64_t currentCycle, bool hitInBB)
 {
   auto victim = find_victim(hitInBB);
   if (victim != nullptr) {
-    victim->fetch(baseAddr, currentCycle);
+    startFetch(*victim, baseAddr, currentCycle);
     victim->prefetch = hitInBB;
+    reindex(*victim);
     if constexpr (BB_DEBUG_LEVEL > 1)
       fmt::print("[BYTECODE BUFFER] Starting fetching in BB: {}, victim: {},  \n", baseAddr, victim->index);
     if (hitInBB)
@@ -68,23 +312,134 @@ void BYTECODE_BUFFER::fetching(uint64_t baseAddr, uint64_t currentCycle, bool hi
   printInterestingThings();
 }
 
+std::size_t BYTECODE_BUFFER::contextSwitch(uint8_t asid, bool flush)
+{
+  current_asid = asid;
+  if (flush)
+    currFetching.first = false;
+  else
+    foreign_rows = true;
+  std::size_t retained = 0;
+  for (auto& entry : buffers) {
+    if (flush) {
+      // The fills in flight are dropped with the rows, their blocks find no row to return to
+      entry.valid = false;
+      entry.fetching = false;
+      stopWriting(entry);
+    }
+    reindex(entry);
+    if (entry.valid && entry.asid == asid)
+      retained++;
+  }
+  return retained;
+}
+
+bool BYTECODE_BUFFER::protectedVictimAvailable(const std::vector<uint64_t>& protectedAddrs) { return find_protected_victim(protectedAddrs) != nullptr; }
+
+void BYTECODE_BUFFER::runaheadFetching(uint64_t baseAddr, uint64_t currentCycle, const std::vector<uint64_t>& protectedAddrs)
+{
+  auto victim = find_protected_victim(protectedAddrs);
+  if (victim == nullptr)
+    return;
+  startFetch(*victim, baseAddr, currentCycle);
+  victim->prefetch = true;
+  victim->runahead = true;
+  reindex(*victim);
+  stats.runahead_prefetches++;
+  if constexpr (BB_DEBUG_LEVEL > 1)
+    fmt::print("[BYTECODE BUFFER] Starting run-ahead fetching in BB: {}, victim: {},  \n", baseAddr, victim->index);
+}
+
+void BYTECODE_BUFFER::dualPathFetching(uint64_t baseAddr, uint64_t currentCycle, const std::vector<uint64_t>& protectedAddrs)
+{
+  auto victim = find_protected_victim(protectedAddrs);
+  if (victim == nullptr)
+    return;
+  startFetch(*victim, baseAddr, currentCycle);
+  victim->prefetch = true;
+  reindex(*victim);
+  stats.prefetches++;
+  if constexpr (BB_DEBUG_LEVEL > 1)
+    fmt::print("[BYTECODE BUFFER] Starting dual path fetching in BB: {}, victim: {},  \n", baseAddr, victim->index);
+}
+
 bool BYTECODE_BUFFER::currentlyFetching(uint64_t baseAddr)
 {
-  for (BB_ENTRY const& entry : buffers) {
-    if (entry.currentlyFetching(baseAddr & ~1))
+  for (auto row : index[bucket(baseAddr & ~1)]) {
+    if (buffers[row].currentlyFetching(baseAddr & ~1))
       return true;
   }
   return false;
 }
 
-bool BYTECODE_BUFFER::blockIsNeeded(uint64_t blockBase)
+bool BYTECODE_BUFFER::inBuffer(uint64_t baseAddr) { return hit(baseAddr) != nullptr; }
+
+bool BYTECODE_BUFFER::inBufferOrFetching(uint64_t baseAddr) { return hit(baseAddr) != nullptr || currentlyFetching(baseAddr); }
+
+bool BYTECODE_BUFFER::snoopStore(uint64_t storeAddr, uint64_t storeBytes)
 {
-  for (BB_ENTRY const& entry : buffers) {
-    if (entry.inCacheBlock(blockBase)) {
-      return true;
+  if (coherence == BB_COHERENCE::NONE)
+    return false;
+  auto first = storeAddr & ~(BYTECODE_SIZE - 1);
+  auto last = (storeAddr + storeBytes - 1) & ~(BYTECODE_SIZE - 1);
+
+  // The rows registered for any granule the store touches, invalidating reindexes them so they are collected first
+  scratch.clear();
+  for (auto granule = first >> granule_bits; granule <= (last >> granule_bits); granule++) {
+    for (auto row : index[bucket(granule << granule_bits)]) {
+      if (std::find(std::begin(scratch), std::end(scratch), row) == std::end(scratch))
+        scratch.push_back(row);
     }
   }
-  return false;
+
+  // Sectors of a row holding [low, high], unsectored rows have only one
+  auto sectors = [this](uint64_t base, uint64_t low, uint64_t high) {
+    if (!sectored)
+      return std::numeric_limits<uint64_t>::max();
+    auto low_sector = (low - base) >> log2_row_bytes;
+    auto high_sector = (high - base) >> log2_row_bytes;
+    return champsim::bitmask(high_sector + 1, low_sector);
+  };
+
+  bool snooped = false;
+  for (auto row : scratch) {
+    BB_ENTRY& entry = buffers[row];
+    if (entry.fetching && first <= entry.fetching_max_addr && last >= entry.fetching_base_addr) {
+      snooped = true;
+      stats.coherence_inflight++;
+      // An update is merged into the block on its way in, an invalidation has to wait for the block to drop it
+      if (coherence == BB_COHERENCE::INVALIDATE)
+        entry.stale_sectors |= sectors(entry.fetching_base_addr, std::max(first, entry.fetching_base_addr), std::min(last, entry.fetching_max_addr));
+    }
+    if (!entry.valid || first > entry.maxAddr || last < entry.baseAddr)
+      continue;
+    auto low = std::max(first, entry.baseAddr);
+    auto high = std::min(last, entry.maxAddr);
+    auto held = sectors(entry.baseAddr, low, high) & entry.valid_sectors;
+    if (held == 0)
+      continue;
+    snooped = true;
+    if (coherence == BB_COHERENCE::INVALIDATE) {
+      invalidate(entry, held);
+    } else {
+      rewriteSlots(entry, entry.slot(low), entry.slot(high));
+      stats.coherence_updates++;
+    }
+  }
+  if (snooped)
+    stats.quickening_writes++;
+  return snooped;
+}
+
+bool BYTECODE_BUFFER::blockIsNeeded(uint64_t blockBase)
+{
+  rowsInBlock(blockBase);
+  return !std::empty(scratch);
+}
+
+void BYTECODE_BUFFER::recordMissWait(const BB_ENTRY& entry, uint64_t currentCycle)
+{
+  stats.totalMissWait += currentCycle - entry.fetchingEventCycle;
 }
 
 bool BYTECODE_BUFFER::updateBufferEntries(uint64_t baseAddr, uint64_t currentCycle)
@@ -92,58 +447,40 @@ bool BYTECODE_BUFFER::updateBufferEntries(uint64_t baseAddr, uint64_t currentCyc
   bool currFetchingFound = false;
   bool alreadyFetched = hit(baseAddr);
 
-  auto initial_entry = std::find_if(buffers.begin(), buffers.end(), [baseAddr](BB_ENTRY entry) { return entry.inCacheBlock(baseAddr & ~1); });
-  if (initial_entry == buffers.end()) {
+  rowsInBlock(baseAddr & ~1);
+  if (std::empty(scratch)) {
     if (!alreadyFetched) {
       fmt::print(stderr, "Big error \n");
       exit(1);
     }
     return false;
   }
-  auto entryToUpdate = &(*initial_entry);
+  auto entryToUpdate = &buffers[scratch.front()];
 
-  for (auto& entry : buffers) {
-    if (entry.inCacheBlock(baseAddr & ~1) && (entry.fetching_base_addr < entryToUpdate->fetching_base_addr)) {
-      entryToUpdate = &entry;
+  for (auto row : scratch) {
+    if (buffers[row].fetching_base_addr < entryToUpdate->fetching_base_addr) {
+      entryToUpdate = &buffers[row];
     }
   }
 
-  entryToUpdate->valid = true;
-  entryToUpdate->fetching = false;
-  if (entryToUpdate->hits_since_last_switch == 0)
-    entryToUpdate->switched_with_no_hits++;
-
-  entryToUpdate->hits_since_last_switch = 0;
-  entryToUpdate->baseAddr = entryToUpdate->fetching_base_addr;
-  entryToUpdate->maxAddr = entryToUpdate->fetching_max_addr;
-  entryToUpdate->lru = STARTING_LRU_VAL;
-  decrementLRUs();
-  entryToUpdate->lru++;
-  if (entryToUpdate->hit(currFetching.second) && currFetching.first) {
+  validate(*entryToUpdate, currentCycle);
+  if (currFetching.first && entryToUpdate->asid == current_asid && entryToUpdate->hit(currFetching.second))
     currFetchingFound = true;
-    stats.totalMissWait += currentCycle - entryToUpdate->fetchingEventCycle;
-  }
 
-  for (auto& entry : buffers) {
+  // The rows are collected again, the block offset bits of baseAddr may differ from the first lookup
+  rowsInBlock(baseAddr);
+  for (auto row : scratch) {
+     BB_ENTRY& entry = buffers[row];
      if (entry.fetching && entry.inCacheBlock(baseAddr)) {
-      if (hit(entry.fetching_base_addr)) {
+      // Only rows of the current address space are indexed, so only they can find a duplicate
+      if (entry.asid == current_asid && hit(entry.fetching_base_addr)) {
         entry.fetching = false;
         stats.duplicated_prefetches++;
+        reindex(entry);
       } else {
-        entry.valid = true;
-        entry.fetching = false;
-        if (entry.hits_since_last_switch == 0)
-          entry.switched_with_no_hits++;
-
-        entry.hits_since_last_switch = 0;
-        entry.baseAddr = entry.fetching_base_addr;
-        entry.maxAddr = entry.fetching_max_addr;
-        entry.lru = STARTING_LRU_VAL;
-
-        if (entry.hit(currFetching.second) && currFetching.first) {
+        validate(entry, currentCycle);
+        if (currFetching.first && entry.asid == current_asid && entry.hit(currFetching.second))
           currFetchingFound = true;
-          stats.totalMissWait += currentCycle - entry.fetchingEventCycle;
-        }
       }
      }
   }
@@ -151,27 +488,21 @@ bool BYTECODE_BUFFER::updateBufferEntries(uint64_t baseAddr, uint64_t currentCyc
   return currFetchingFound;
 }
 
-void BYTECODE_BUFFER::decrementLRUs()
-{
-  for (BB_ENTRY& entry : buffers) {
-    if (entry.valid && entry.lru > 0)
-      entry.lru--;
-  }
-}
-
 BB_ENTRY* BYTECODE_BUFFER::hit(uint64_t sourceMemoryAddr)
 {
-  for (BB_ENTRY& entry : buffers) {
-    if (entry.hit(sourceMemoryAddr)) {
-      return const_cast<BB_ENTRY*>(&entry);
+  // Lowest row wins if several rows hold the address
+  BB_ENTRY* found = nullptr;
+  for (auto row : index[bucket(sourceMemoryAddr)]) {
+    if (buffers[row].hit(sourceMemoryAddr) && (found == nullptr || row < found->index)) {
+      found = &buffers[row];
     }
   }
-  return nullptr;
+  return found;
 }
 
 BB_ENTRY* BYTECODE_BUFFER::find_victim(bool prefetch)
 {
-  auto initial_entry = std::find_if(buffers.begin(), buffers.end(), [](BB_ENTRY entry) { return !entry.fetching; });
+  auto initial_entry = std::find_if(buffers.begin(), buffers.end(), [](const BB_ENTRY& entry) { return !entry.busy(); });
   if (initial_entry == buffers.end()) {
     auto prefetch_entry = std::find_if(buffers.begin(), buffers.end(), [](BB_ENTRY entry) { return entry.fetching && entry.prefetch; });
     if (prefetch_entry != buffers.end()) {
@@ -201,7 +532,7 @@ BB_ENTRY* BYTECODE_BUFFER::find_victim(bool prefetch)
   } else {
     auto victim = &(*initial_entry);
     for (auto& entry : buffers) {
-      if (!entry.fetching && (entry.lru < victim->lru)) {
+      if (!entry.busy() && (entry.lru < victim->lru)) {
         victim = &entry;
       }
     }
@@ -209,6 +540,18 @@ BB_ENTRY* BYTECODE_BUFFER::find_victim(bool prefetch)
   }
 }
 
+BB_ENTRY* BYTECODE_BUFFER::find_protected_victim(const std::vector<uint64_t>& protectedAddrs)
+{
+  BB_ENTRY* victim = nullptr;
+  for (auto& entry : buffers) {
+    bool is_protected = std::any_of(std::begin(protectedAddrs), std::end(protectedAddrs), [&entry](uint64_t addr) { return entry.hit(addr); });
+    if (!entry.busy() && !is_protected && (victim == nullptr || entry.lru < victim->lru)) {
+      victim = &entry;
+    }
+  }
+  return victim;
+}
+
 void BYTECODE_BUFFER::printInterestingThings()
 {
   fmt::print("Duplicated prefetces: {}, aggressive prefetches: {} \n", stats.duplicated_prefetches, stats.aggressive_prefetches);
@@ -228,6 +571,26 @@ void BYTECODE_BUFFER::generateStats()
   }
 }
 
+uint64_t BYTECODE_BUFFER::storageBits() const
+{
+  // Bytecodes, a base address tag, valid, fetching and an LRU rank per row. A sectored row holds its whole cache
+  // block behind a block tag, with a valid bit per sector; other rows start at any bytecode.
+  uint64_t row_bits = 1 + 1 + champsim::lg2(rows);
+  if (sectored)
+    row_bits += 8 * BLOCK_SIZE + (64 - LOG2_BLOCK_SIZE) + (BLOCK_SIZE >> log2_row_bytes);
+  else
+    row_bits += 8 * BYTECODE_SIZE * rowSize() + (64 - champsim::lg2(BYTECODE_SIZE));
+  // Invalidated rows mark the sectors a store hit while their block was in flight
+  if (coherence == BB_COHERENCE::INVALIDATE)
+    row_bits += sectored ? (BLOCK_SIZE >> log2_row_bytes) : 1;
+  // Rows written a few bytecodes per cycle keep a written bit per bytecode and the next slot to write
+  if (fill_width > 0) {
+    auto slots = sectored ? BLOCK_SIZE / BYTECODE_SIZE : rowSize();
+    row_bits += slots + champsim::lg2(slots);
+  }
+  return rows * row_bits;
+}
+
 void BYTECODE_BUFFER::resetStats()
 {
   BB_STATS newStats;
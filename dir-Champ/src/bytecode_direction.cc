@@ -0,0 +1,96 @@
+#include "bytecode_direction.h"
+
+#include <cstdlib>
+#include <fmt/core.h>
+
+#include "bytecode_buffer.h"
+#include "bytecode_opcodes.h"
+#include "util/bits.h"
+
+namespace
+{
+using namespace bytecode_opcode;
+
+// COMPARE_OP_*_JUMP runs the POP_JUMP after its two inline cache entries
+constexpr uint64_t COMPARE_OP_CACHE_ENTRIES = 2;
+
+constexpr uint8_t CTR_MAX = (1u << DIRECTION_CTR_BITS) - 1;
+constexpr uint8_t CTR_TAKEN = 1u << (DIRECTION_CTR_BITS - 1);
+} // namespace
+
+BYTECODE_DIRECTION::BYTECODE_DIRECTION(std::size_t num_entries, std::size_t history_bits)
+    : entries(num_entries), history_length(history_bits), index_bits(num_entries > 0 ? champsim::lg2(num_entries) : 0), counters(num_entries, CTR_TAKEN - 1)
+{
+  if ((entries & (entries - 1)) != 0 || history_length > 64) {
+    fmt::print(stderr, "Bytecode direction predictor needs a power of two number of entries and at most 64 history bits, got entries: {} history: {}\n",
+               entries, history_length);
+    exit(1);
+  }
+}
+
+bool BYTECODE_DIRECTION::isConditional(int opcode)
+{
+  switch (opcode) {
+  case COMPARE_OP_FLOAT_JUMP:
+  case COMPARE_OP_INT_JUMP:
+  case COMPARE_OP_STR_JUMP:
+  case FOR_ITER:
+  case JUMP_IF_FALSE_OR_POP:
+  case JUMP_IF_TRUE_OR_POP:
+  case POP_JUMP_FORWARD_IF_FALSE:
+  case POP_JUMP_FORWARD_IF_TRUE:
+  case POP_JUMP_FORWARD_IF_NOT_NONE:
+  case POP_JUMP_FORWARD_IF_NONE:
+  case POP_JUMP_BACKWARD_IF_NOT_NONE:
+  case POP_JUMP_BACKWARD_IF_NONE:
+  case POP_JUMP_BACKWARD_IF_FALSE:
+  case POP_JUMP_BACKWARD_IF_TRUE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+int64_t BYTECODE_DIRECTION::fallThrough(int opcode)
+{
+  if (opcode == COMPARE_OP_FLOAT_JUMP || opcode == COMPARE_OP_INT_JUMP || opcode == COMPARE_OP_STR_JUMP)
+    return BYTECODE_SIZE * (1 + COMPARE_OP_CACHE_ENTRIES + 1);
+  return BYTECODE_SIZE;
+}
+
+std::size_t BYTECODE_DIRECTION::index(uint64_t bpc) const
+{
+  auto hist = history & champsim::bitmask(history_length);
+  return ((bpc / BYTECODE_SIZE) ^ hist ^ (hist << (index_bits / 2))) & champsim::bitmask(index_bits);
+}
+
+bool BYTECODE_DIRECTION::predict(uint64_t bpc)
+{
+  last_index = index(bpc);
+  last_taken = counters[last_index] >= CTR_TAKEN;
+  stats.predictions++;
+  if (last_taken)
+    stats.predicted_taken++;
+  return last_taken;
+}
+
+bool BYTECODE_DIRECTION::peek(uint64_t bpc) const { return counters[index(bpc)] >= CTR_TAKEN; }
+
+void BYTECODE_DIRECTION::update(bool taken)
+{
+  if (last_taken == taken)
+    stats.correct++;
+
+  auto& ctr = counters[last_index];
+  if (taken && ctr < CTR_MAX)
+    ctr++;
+  else if (!taken && ctr > 0)
+    ctr--;
+  if (taken)
+    stats.taken++;
+  history = (history << 1) | (taken ? 1 : 0);
+}
+
+uint64_t BYTECODE_DIRECTION::storageBits() const { return entries * DIRECTION_CTR_BITS + history_length; }
+
+void BYTECODE_DIRECTION::resetStats() { stats = DIRECTION_STATS{}; }
@@ -0,0 +1,97 @@
+#include "bytecode_fusion.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/core.h>
+
+#include "bytecode_buffer.h"
+
+BYTECODE_FUSION::BYTECODE_FUSION(std::size_t num_entries, unsigned fuse_threshold) : entries(num_entries), threshold(fuse_threshold), table(num_entries)
+{
+  if (threshold == 0 || threshold >= (1u << FUSION_COUNTER_BITS)) {
+    fmt::print(stderr, "Fusion threshold must be between 1 and {}, got {}\n", (1u << FUSION_COUNTER_BITS) - 1, threshold);
+    exit(1);
+  }
+}
+
+FUSION_ENTRY* BYTECODE_FUSION::find(int first, int second)
+{
+  auto entry = std::find_if(std::begin(table), std::end(table), [=](const FUSION_ENTRY& e) { return e.valid && e.first == first && e.second == second; });
+  return (entry != std::end(table)) ? &(*entry) : nullptr;
+}
+
+void BYTECODE_FUSION::train(int first, int second)
+{
+  stats.observed_pairs++;
+  if (++observations % FUSION_DECAY_PERIOD == 0) {
+    // Age every pair, so a phase change lets new pairs take over
+    for (auto& entry : table)
+      entry.counter >>= 1;
+  }
+
+  auto entry = find(first, second);
+  if (entry == nullptr) {
+    // Pairs that are not hot enough to be fused give way to new ones
+    auto victim = std::min_element(std::begin(table), std::end(table), [](const FUSION_ENTRY& a, const FUSION_ENTRY& b) { return a.counter < b.counter; });
+    if (victim->valid && victim->counter >= threshold)
+      return;
+    *victim = FUSION_ENTRY{first, second, 0, true};
+    stats.allocations++;
+    entry = &(*victim);
+  }
+  entry->counter = std::min(entry->counter + 1, (1u << FUSION_COUNTER_BITS) - 1);
+}
+
+bool BYTECODE_FUSION::dispatch(uint64_t bpc, int opcode, bool skippable)
+{
+  if (!enabled())
+    return false;
+
+  bool fused = false;
+  if (skippable && last_valid && bpc == last_bpc + BYTECODE_SIZE) {
+    // Only pairs are fused, the second half of a fused pair does not start another one
+    auto entry = find(last_opcode, opcode);
+    fused = !last_fused && entry != nullptr && entry->counter >= threshold;
+    if (fused) {
+      fused_pair = {last_opcode, opcode};
+      counters[fused_pair].fused++;
+      stats.fused++;
+    }
+    train(last_opcode, opcode);
+  }
+
+  last_valid = skippable;
+  last_fused = fused;
+  last_bpc = bpc;
+  last_opcode = opcode;
+  return fused;
+}
+
+void BYTECODE_FUSION::recordSavings(uint64_t instructions, uint64_t cycles)
+{
+  auto& counter = counters[fused_pair];
+  counter.instructions_saved += instructions;
+  counter.cycles_saved += cycles;
+  stats.instructions_saved += instructions;
+  stats.cycles_saved += cycles;
+}
+
+void BYTECODE_FUSION::generateStats()
+{
+  for (auto const& [pair, counter] : counters)
+    stats.pairStats.push_back(FUSION_PAIR_STATS{pair.first, pair.second, counter.fused, counter.instructions_saved, counter.cycles_saved});
+  // Hottest pairs first
+  std::sort(std::begin(stats.pairStats), std::end(stats.pairStats), [](const FUSION_PAIR_STATS& a, const FUSION_PAIR_STATS& b) { return a.fused > b.fused; });
+}
+
+void BYTECODE_FUSION::resetStats()
+{
+  stats = FUSION_STATS{};
+  counters.clear();
+}
+
+uint64_t BYTECODE_FUSION::storageBits() const
+{
+  // valid, both opcodes and the counter, the lowest counter is the replacement state
+  return entries * (1 + 2 * 8 + FUSION_COUNTER_BITS);
+}
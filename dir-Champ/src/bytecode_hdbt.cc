@@ -1,79 +1,165 @@
 #include "bytecode_hdbt.h"
 
 #include <algorithm>
-#include <random>
+#include <cstdlib>
+#include <utility>
+
+BYTECODE_HDBT::BYTECODE_HDBT(std::size_t num_sets, std::size_t num_ways, HDBT_REPLACEMENT repl, std::size_t prefetch_depth_)
+    : sets(num_sets), ways(num_ways), set_bits(champsim::lg2(num_sets)), replacement(repl), table(num_sets * num_ways), prefetch_depth(prefetch_depth_)
+{
+  if (sets == 0 || ways == 0 || (sets & (sets - 1)) != 0) {
+    fmt::print(stderr, "HDBT needs a power of two number of sets and at least one way, got sets: {} ways: {}\n", sets, ways);
+    exit(1);
+  }
+}
+
 void BYTECODE_HDBT::initialize() {}
 
+std::size_t BYTECODE_HDBT::set_index(int opcode) const
+{
+  // Fold the upper opcode bits into the index so that small tables still spread the opcode space
+  auto code = static_cast<uint64_t>(opcode);
+  return (code ^ (code >> set_bits)) & champsim::bitmask(set_bits);
+}
+
 bool BYTECODE_HDBT::hit(int opcode)
 {
-  auto entry = std::find_if(table.begin(), table.end(), [opcode](HDBT_ENTRY entry) { return entry.opcode == opcode; });
-  if (entry != table.end()) {
-    if (entry->valid) {
-      entry->hits++;
-      stats.hits++;
-      decrementLRUs();
-      entry->lru = STARTING_HDBT_LRU_VAL;
-      return true;
-    } else {
-      entry->valid = true;
-      entry->lru = STARTING_HDBT_LRU_VAL;
-      entry->miss++;
-    }
+  auto set = set_index(opcode);
+  auto set_begin = std::next(std::begin(table), static_cast<long>(set * ways));
+  auto set_end = std::next(set_begin, static_cast<long>(ways));
+  auto& counter = counters.at(static_cast<std::size_t>(opcode) % HDBT_NUM_OPCODES);
+  counter.seen = true;
+  access_counter++;
+
+  // Check every way without an early exit or a branch per way. Which way matches depends on the stream, so a
+  // short-circuiting compare mispredicts as soon as a set holds more than one valid entry
+  HDBT_ENTRY* entry = nullptr;
+  for (auto way = set_begin; way != set_end; ++way) {
+    auto mismatch = static_cast<unsigned>(way->opcode ^ opcode) | static_cast<unsigned>(!way->valid);
+    entry = (mismatch == 0) ? &(*way) : entry;
   }
-  auto victim = find_victim();
-  if (victim != nullptr) {
-    victim->valid = false;
-    victim->timesSwitchedOut++;
+  if (entry != nullptr) {
+    entry->last_used = access_counter;
+    counter.hits++;
+    stats.hits++;
+    return true;
   }
-  decrementLRUs();
-  if (entry == table.end()) {
-    table.push_back({opcode});
+
+  auto victim = find_victim(set);
+  if (victim->valid) {
+    counters.at(static_cast<std::size_t>(victim->opcode) % HDBT_NUM_OPCODES).timesSwitchedOut++;
   }
+  victim->opcode = opcode;
+  victim->valid = true;
+  victim->handler = 0;
+  victim->last_used = access_counter;
+  victim->inserted = access_counter;
+  counter.miss++;
   stats.miss++;
   return false;
 }
 
-void BYTECODE_HDBT::decrementLRUs()
+const HDBT_ENTRY* BYTECODE_HDBT::find(int opcode) const
+{
+  auto set_begin = std::next(std::begin(table), static_cast<long>(set_index(opcode) * ways));
+  auto set_end = std::next(set_begin, static_cast<long>(ways));
+  auto entry = std::find_if(set_begin, set_end, [=](const HDBT_ENTRY& e) { return e.valid && e.opcode == opcode; });
+  return (entry != set_end) ? &(*entry) : nullptr;
+}
+
+HDBT_ENTRY* BYTECODE_HDBT::find(int opcode) { return const_cast<HDBT_ENTRY*>(std::as_const(*this).find(opcode)); }
+
+bool BYTECODE_HDBT::contains(int opcode) const { return find(opcode) != nullptr; }
+
+uint64_t BYTECODE_HDBT::handler(int opcode) const
+{
+  auto entry = find(opcode);
+  return (entry != nullptr) ? entry->handler : 0;
+}
+
+void BYTECODE_HDBT::learnHandler(int opcode, uint64_t handler_addr)
+{
+  auto entry = find(opcode);
+  if (entry != nullptr)
+    entry->handler = handler_addr;
+}
+
+void BYTECODE_HDBT::prefetchedHandler(uint64_t handler_addr)
+{
+  stats.handler_prefetches++;
+  prefetched_handler = handler_addr;
+}
+
+bool BYTECODE_HDBT::coveredDispatch(uint64_t handler_addr)
+{
+  stats.handler_dispatches++;
+  bool covered = (prefetched_handler != 0 && prefetched_handler == handler_addr);
+  if (covered)
+    stats.covered++;
+  prefetched_handler = 0;
+  return covered;
+}
+
+std::size_t BYTECODE_HDBT::contextSwitch(bool flush)
 {
-  for (auto& entry : table) {
-    if (entry.valid && entry.lru > 0)
-      entry.lru--;
+  prefetched_handler = 0;
+  if (flush) {
+    for (auto& entry : table)
+      entry.valid = false;
   }
+  return static_cast<std::size_t>(std::count_if(std::begin(table), std::end(table), [](const HDBT_ENTRY& entry) { return entry.valid; }));
 }
 
-HDBT_ENTRY* BYTECODE_HDBT::find_victim()
+HDBT_ENTRY* BYTECODE_HDBT::find_victim(std::size_t set)
 {
-  if (table.size() < HDBT_SIZE) {
-    return nullptr;
+  auto set_begin = std::next(std::begin(table), static_cast<long>(set * ways));
+  auto set_end = std::next(set_begin, static_cast<long>(ways));
+
+  auto invalid = std::find_if_not(set_begin, set_end, [](const HDBT_ENTRY& entry) { return entry.valid; });
+  if (invalid != set_end) {
+    return &(*invalid);
   }
-  auto initial_entry = std::find_if(table.begin(), table.end(), [](HDBT_ENTRY entry) { return entry.valid; });
-
-  for (auto& entry : table) {
-    auto victim = &(*initial_entry);
-    for (auto& entry : table) {
-      if (entry.valid && (entry.lru < victim->lru)) {
-        victim = &entry;
-      }
-    }
-    return victim;
+
+  switch (replacement) {
+  case HDBT_REPLACEMENT::FIFO:
+    return &(*std::min_element(set_begin, set_end, [](const HDBT_ENTRY& a, const HDBT_ENTRY& b) { return a.inserted < b.inserted; }));
+  case HDBT_REPLACEMENT::RANDOM:
+    // xorshift64, deterministic between runs
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return &(*std::next(set_begin, static_cast<long>(rng_state % ways)));
+  case HDBT_REPLACEMENT::LRU:
+  default:
+    return &(*std::min_element(set_begin, set_end, [](const HDBT_ENTRY& a, const HDBT_ENTRY& b) { return a.last_used < b.last_used; }));
   }
-  return nullptr;
 }
 
 void BYTECODE_HDBT::generateStats()
 {
-  for (auto const& entry : table) {
-    stats.entryStats.emplace_back(HDBT_ENTRY_STATS(entry.opcode, entry.timesSwitchedOut, entry.hits, entry.miss));
+  for (std::size_t opcode = 0; opcode < HDBT_NUM_OPCODES; opcode++) {
+    auto const& counter = counters[opcode];
+    if (counter.seen) {
+      stats.entryStats.emplace_back(HDBT_ENTRY_STATS(static_cast<uint8_t>(opcode), counter.timesSwitchedOut, counter.hits, counter.miss));
+    }
   }
 }
 
+uint64_t BYTECODE_HDBT::storageBits() const
+{
+  // valid, the opcode bits the set index does not give back, the handler address and the replacement rank
+  uint64_t tag_bits = champsim::lg2(HDBT_NUM_OPCODES) - std::min(set_bits, champsim::lg2(HDBT_NUM_OPCODES));
+  uint64_t rank_bits = (replacement == HDBT_REPLACEMENT::RANDOM) ? 0 : champsim::lg2(std::max<std::size_t>(ways, 1));
+  return size() * (1 + tag_bits + 64 + rank_bits);
+}
+
 void BYTECODE_HDBT::resetStats()
 {
   HDBT_STATS newStats;
   stats = newStats;
-  for (auto &entry : table) {
-    entry.timesSwitchedOut = 0;
-    entry.hits = 0;
-    entry.miss = 0;
+  for (auto& counter : counters) {
+    counter.timesSwitchedOut = 0;
+    counter.hits = 0;
+    counter.miss = 0;
   }
-}
\ No newline at end of file
+}
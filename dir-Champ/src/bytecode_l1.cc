@@ -0,0 +1,87 @@
+#include "bytecode_l1.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/core.h>
+
+#include "champsim_constants.h"
+#include "util/bits.h"
+
+BYTECODE_L1::BYTECODE_L1(std::size_t size_bytes, std::size_t num_ways, uint64_t hit_latency, std::size_t num_mshrs)
+    : sets(num_ways > 0 ? size_bytes / (BLOCK_SIZE * num_ways) : 0), ways(num_ways), mshr_size(num_mshrs), latency(hit_latency), blocks(sets * ways)
+{
+  if (size_bytes == 0)
+    return;
+  if (ways == 0 || sets * ways * BLOCK_SIZE != size_bytes || (sets & (sets - 1)) != 0 || mshr_size == 0) {
+    fmt::print(stderr, "Bytecode L1 needs a power of two number of sets of {} byte blocks and at least one MSHR, got size: {} ways: {} mshrs: {}\n",
+               BLOCK_SIZE, size_bytes, ways, mshr_size);
+    exit(1);
+  }
+}
+
+std::size_t BYTECODE_L1::set_index(uint64_t address) const { return (address >> LOG2_BLOCK_SIZE) & champsim::bitmask(champsim::lg2(sets)); }
+
+bool BYTECODE_L1::access(uint64_t address, uint64_t cycle)
+{
+  auto block_addr = address >> LOG2_BLOCK_SIZE;
+  auto set_begin = std::next(std::begin(blocks), static_cast<long>(set_index(address) * ways));
+  auto set_end = std::next(set_begin, static_cast<long>(ways));
+  auto way = std::find_if(set_begin, set_end, [block_addr](const BYTECODE_L1_BLOCK& b) { return b.valid && b.address == block_addr; });
+  if (way != set_end) {
+    way->lru = ++access_counter;
+    hits_in_flight.emplace_back(cycle + latency, address);
+    stats.hits++;
+    return true;
+  }
+
+  stats.miss++;
+  if (std::any_of(std::begin(mshr), std::end(mshr), [block_addr](const BYTECODE_L1_MSHR& m) { return m.address == block_addr; })) {
+    stats.merged++;
+    return true;
+  }
+  return false;
+}
+
+void BYTECODE_L1::allocate(uint64_t address, uint64_t cycle)
+{
+  if (std::size(mshr) < mshr_size)
+    mshr.push_back(BYTECODE_L1_MSHR{address >> LOG2_BLOCK_SIZE, cycle});
+  else
+    stats.mshr_full++;
+}
+
+void BYTECODE_L1::fill(uint64_t address, uint64_t cycle)
+{
+  auto block_addr = address >> LOG2_BLOCK_SIZE;
+  auto entry = std::find_if(std::begin(mshr), std::end(mshr), [block_addr](const BYTECODE_L1_MSHR& m) { return m.address == block_addr; });
+  if (entry == std::end(mshr))
+    return;
+  stats.fills++;
+  stats.totalFillWait += cycle - entry->cycle_enqueued;
+  mshr.erase(entry);
+
+  auto set_begin = std::next(std::begin(blocks), static_cast<long>(set_index(address) * ways));
+  auto set_end = std::next(set_begin, static_cast<long>(ways));
+  auto victim = std::min_element(set_begin, set_end, [](const BYTECODE_L1_BLOCK& a, const BYTECODE_L1_BLOCK& b) {
+    return std::pair{a.valid, a.lru} < std::pair{b.valid, b.lru};
+  });
+  *victim = BYTECODE_L1_BLOCK{block_addr, ++access_counter, true};
+}
+
+uint64_t BYTECODE_L1::nextHit(uint64_t cycle)
+{
+  if (std::empty(hits_in_flight) || hits_in_flight.front().first > cycle)
+    return 0;
+  auto address = hits_in_flight.front().second;
+  hits_in_flight.pop_front();
+  return address;
+}
+
+uint64_t BYTECODE_L1::storageBits() const
+{
+  // Data, a virtual block address tag, valid and an LRU rank per block
+  uint64_t block_bits = 8 * BLOCK_SIZE + (64 - LOG2_BLOCK_SIZE) + 1 + champsim::lg2(std::max<std::size_t>(ways, 1));
+  return std::size(blocks) * block_bits;
+}
+
+void BYTECODE_L1::resetStats() { stats = BYTECODE_L1_STATS{}; }
@@ -0,0 +1,121 @@
+#include "bytecode_loop.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "bytecode_btb.h"
+#include "bytecode_direction.h"
+#include "bytecode_opcodes.h"
+#include "util/bits.h"
+
+namespace
+{
+using namespace bytecode_opcode;
+
+constexpr uint16_t MAX_TRIP = (1u << LOOP_TRIP_BITS) - 1;
+} // namespace
+
+BYTECODE_LOOP::BYTECODE_LOOP(std::size_t num_entries, std::size_t prefetch_distance_) : table(num_entries), prefetch_distance(prefetch_distance_) {}
+
+bool BYTECODE_LOOP::isLoopBranch(int opcode)
+{
+  return opcode == FOR_ITER || opcode == POP_JUMP_BACKWARD_IF_NOT_NONE || opcode == POP_JUMP_BACKWARD_IF_NONE || opcode == POP_JUMP_BACKWARD_IF_FALSE
+         || opcode == POP_JUMP_BACKWARD_IF_TRUE;
+}
+
+bool BYTECODE_LOOP::exitIsTaken(int opcode) { return opcode == FOR_ITER; }
+
+const LOOP_ENTRY* BYTECODE_LOOP::find(uint64_t bpc) const
+{
+  auto entry = std::find_if(std::begin(table), std::end(table), [bpc](const LOOP_ENTRY& e) { return e.valid && e.bpc == bpc; });
+  return (entry != std::end(table)) ? &(*entry) : nullptr;
+}
+
+LOOP_ENTRY* BYTECODE_LOOP::find(uint64_t bpc) { return const_cast<LOOP_ENTRY*>(std::as_const(*this).find(bpc)); }
+
+int64_t BYTECODE_LOOP::predict(uint64_t bpc, int opcode)
+{
+  last_override = 0;
+  auto entry = find(bpc);
+  if (entry == nullptr || entry->confidence < LOOP_CONFIDENT || entry->taken_jump == 0)
+    return 0;
+
+  last_exit = (entry->current >= entry->trip);
+  bool taken = (last_exit == exitIsTaken(opcode));
+  last_override = taken ? entry->taken_jump : BYTECODE_DIRECTION::fallThrough(opcode);
+  stats.overrides++;
+  if (last_exit)
+    stats.exit_overrides++;
+  return last_override;
+}
+
+void BYTECODE_LOOP::update(uint64_t bpc, int opcode, int64_t correct_jump)
+{
+  bool taken = (correct_jump != BYTECODE_DIRECTION::fallThrough(opcode));
+  bool leaves = (taken == exitIsTaken(opcode));
+
+  if (last_override != 0 && last_override == correct_jump) {
+    stats.correct++;
+    if (leaves && last_exit)
+      stats.exit_correct++;
+  }
+  last_override = 0;
+
+  auto entry = find(bpc);
+  if (entry == nullptr) {
+    // Loops are learned from their first exit on
+    if (!leaves)
+      return;
+    entry = &(*std::min_element(std::begin(table), std::end(table), [](const LOOP_ENTRY& a, const LOOP_ENTRY& b) {
+      return std::pair{a.valid, a.lru} < std::pair{b.valid, b.lru};
+    }));
+    *entry = LOOP_ENTRY{};
+    entry->bpc = bpc;
+    entry->valid = true;
+    entry->confidence = -1; // The first exit gives no trip count yet
+    stats.allocations++;
+  }
+  entry->lru = ++access_counter;
+  if (taken)
+    entry->taken_jump = correct_jump;
+
+  if (!leaves) {
+    if (entry->current == MAX_TRIP) {
+      // Longer than the trip counter can hold, leave it to the other predictors
+      entry->confidence = 0;
+      return;
+    }
+    entry->current++;
+    return;
+  }
+
+  if (entry->confidence >= 0 && entry->current == entry->trip) {
+    if (entry->confidence < LOOP_MAX_CONFIDENCE)
+      entry->confidence++;
+  } else {
+    entry->trip = entry->current;
+    entry->confidence = 0;
+  }
+  entry->current = 0;
+}
+
+uint64_t BYTECODE_LOOP::exitPrefetch(uint64_t bpc, int opcode) const
+{
+  if (prefetch_distance == 0)
+    return 0;
+  auto entry = find(bpc);
+  if (entry == nullptr || entry->confidence < LOOP_CONFIDENT || entry->taken_jump == 0)
+    return 0;
+  if (entry->current >= entry->trip || static_cast<std::size_t>(entry->trip - entry->current) != prefetch_distance)
+    return 0;
+  return bpc + static_cast<uint64_t>(exitIsTaken(opcode) ? entry->taken_jump : BYTECODE_DIRECTION::fallThrough(opcode));
+}
+
+uint64_t BYTECODE_LOOP::storageBits() const
+{
+  // valid, full BPC tag, taken jump, trip and iteration counters, confidence and an LRU rank
+  uint64_t entry_bits = 1 + 64 + DBTB_JUMP_BITS + 2 * LOOP_TRIP_BITS + 3 + champsim::lg2(std::max<std::size_t>(std::size(table), 1));
+  return std::size(table) * entry_bits;
+}
+
+void BYTECODE_LOOP::resetStats() { stats = LOOP_STATS{}; }
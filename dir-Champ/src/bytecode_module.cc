@@ -8,10 +8,23 @@ void BYTECODE_MODULE::initialize(uint32_t cpu) {
 uint64_t BYTECODE_MODULE::predict_branching(int opcode, int oparg, uint64_t current_bpc) 
 {
     // handle branch prediction for all instructions as at this point we do not know if the instruction is a branch
-    auto predicted_branch_target = btb_prediction(opcode, oparg);
+    auto predicted_branch_target = btb_prediction(opcode, oparg, current_bpc);
     last_branch_opcode = opcode;
     last_branch_oparg = oparg;
     last_bpc = current_bpc;
+    last_ras_prediction = 0;
+    pending_call_return = 0;
+    if (BYTECODE_RAS::isCall(opcode)) {
+        pending_call_return = current_bpc + BYTECODE_RAS::returnOffset(opcode);
+        ras.push(pending_call_return);
+    } else if (BYTECODE_RAS::isReturn(opcode)) {
+        // The caller's frame continues after its call, which the BTB cannot know
+        last_ras_prediction = ras.pop();
+        if (last_ras_prediction != 0) {
+            last_prediction = last_ras_prediction;
+            return last_ras_prediction;
+        }
+    }
     if (predicted_branch_target == 0) {
         last_prediction = 0;
         return current_bpc + BYTECODE_SIZE * BYTECODE_FETCH_TIME;
@@ -22,12 +35,26 @@ uint64_t BYTECODE_MODULE::predict_branching(int opcode, int oparg, uint64_t curr
 
 bool BYTECODE_MODULE::correctPrediction(uint64_t correct_target)
 {
-    update_btb(last_branch_opcode, last_branch_oparg, correct_target - last_bpc);
+    if (switched_context) {
+        switched_context = false;
+        pending_call_return = 0;
+        return false;
+    }
+    update_btb(last_branch_opcode, last_branch_oparg, last_bpc, correct_target - last_bpc);
+    if (pending_call_return != 0 && pending_call_return == correct_target)
+        ras.popFrameless(pending_call_return);
+    pending_call_return = 0;
+    if (last_ras_prediction != 0) {
+        if (last_ras_prediction == correct_target)
+            ras.stats.hits++;
+        else
+            ras.stats.miss++;
+    }
     if (last_prediction != 0) {
         if (last_prediction == correct_target) {
             stats.strongly_correct++;
             return true;
-        } else if ((last_prediction >> LOG2_BB_BUFFER_SIZE) << LOG2_BB_BUFFER_SIZE == (correct_target >> LOG2_BB_BUFFER_SIZE) << LOG2_BB_BUFFER_SIZE) {
+        } else if ((last_prediction >> bb_buffer.log2RowSize()) == (correct_target >> bb_buffer.log2RowSize())) {
             stats.weakly_correct++;
             return false;
         } else {
@@ -38,10 +65,165 @@ bool BYTECODE_MODULE::correctPrediction(uint64_t correct_target)
     return true;
 }
 
+void BYTECODE_MODULE::recordBytecode(uint64_t bpc, int opcode, int oparg)
+{
+    if (pending_dual_path != 0 && pending_dual_path == bpc)
+        bb_buffer.stats.dual_path_used++;
+    pending_dual_path = 0;
+
+    auto& entry = decode_table[(bpc / BYTECODE_SIZE) % RUNAHEAD_DECODE_SIZE];
+    entry.bpc = bpc;
+    entry.opcode = opcode;
+    entry.oparg = oparg;
+    entry.valid = true;
+}
+
+void BYTECODE_MODULE::switchContext(uint8_t asid)
+{
+    if (seen_context && asid == current_asid)
+        return;
+    // The first bytecode load only tells the structures which ASID they start in
+    bool first = !seen_context;
+    seen_context = true;
+    current_asid = asid;
+    if (!first)
+        stats.context_switches++;
+    if (context_switch == BYTECODE_CONTEXT_SWITCH::NONE)
+        return;
+
+    bool flush = (context_switch == BYTECODE_CONTEXT_SWITCH::FLUSH);
+    auto bb_rows = bb_buffer.contextSwitch(asid, flush);
+    auto hdbt_entries = hdbt.contextSwitch(flush);
+    auto dbtb_entries = dbtb.contextSwitch(asid, flush);
+    if (first)
+        return;
+    stats.switch_bb_rows += bb_rows;
+    stats.switch_hdbt_entries += hdbt_entries;
+    stats.switch_dbtb_entries += dbtb_entries;
+    if (flush)
+        decode_table = {};
+    switched_context = true;
+}
+
+void BYTECODE_MODULE::snoopStore(uint64_t storeAddr, uint64_t storeBytes)
+{
+    if (!bb_buffer.snoopStore(storeAddr, storeBytes))
+        return;
+    // The opcodes recorded for the stored BPCs are the ones being rewritten. They are stale from now on, an updated
+    // row is decoded again when the bytecode is next read out of it. The store is counted by the first one it hits
+    int opcode = 0;
+    auto last = (storeAddr + storeBytes - 1) & ~(BYTECODE_SIZE - 1);
+    for (auto bpc = storeAddr & ~(BYTECODE_SIZE - 1); bpc <= last; bpc += BYTECODE_SIZE) {
+        auto& entry = decode_table[(bpc / BYTECODE_SIZE) % RUNAHEAD_DECODE_SIZE];
+        if (entry.valid && entry.bpc == bpc) {
+            if (opcode == 0)
+                opcode = entry.opcode;
+            entry.valid = false;
+        }
+    }
+    stats.quickening_writes[opcode]++;
+}
+
+uint64_t BYTECODE_MODULE::runaheadNext(uint64_t bpc, int min_confidence)
+{
+    // The opcode and oparg can only be read out of a row the BB holds, a row still in flight ends the run-ahead
+    auto [opcode, oparg] = bufferedBytecode(bpc);
+    if (opcode < 0)
+        return 0;
+    if (direction.enabled() && BYTECODE_DIRECTION::isConditional(opcode) && !direction.peek(bpc))
+        return bpc + BYTECODE_DIRECTION::fallThrough(opcode);
+    auto [jump, confidence] = dbtb.predictionWithConfidence(opcode, oparg);
+    if (confidence < min_confidence)
+        return 0;
+    if (jump == 0)
+        return bpc + BYTECODE_SIZE;
+    return bpc + jump;
+}
+
+uint64_t BYTECODE_MODULE::dualPathTarget(uint64_t bpc, int opcode, int oparg, uint64_t predicted_next_bpc)
+{
+    if (bb_buffer.dual_path_confidence == 0 || !BYTECODE_DIRECTION::isConditional(opcode))
+        return 0;
+    // The confidence of the predictor that made the prediction, TAGE falls back to the DBTB itself
+    auto [jump, confidence] = (target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE) ? tage.predictionWithConfidence(dbtb, opcode, oparg, bpc)
+                                                                                   : dbtb.predictionWithConfidence(opcode, oparg);
+    auto fall_through = BYTECODE_DIRECTION::fallThrough(opcode);
+    if (confidence >= bb_buffer.dual_path_confidence)
+        return 0;
+    if (predicted_next_bpc != bpc + fall_through)
+        return bpc + fall_through;
+    // The taken target is only known once the target predictor has seen the branch taken
+    if (jump == 0 || jump == fall_through)
+        return 0;
+    return bpc + jump;
+}
+
+std::tuple<uint64_t, uint8_t, uint64_t> BYTECODE_MODULE::predecode(uint64_t bpc, int opcode, int oparg)
+{
+    if (predecode_predicted)
+        correctPrediction(bpc);
+    auto next_bpc = predict_branching(opcode, oparg, bpc);
+    predecode_predicted = true;
+    // The load of this bytecode happens in the previous handler, which dispatches to it
+    predecode_running = predecode_loaded;
+    predecode_loaded = opcode;
+
+    auto next_opcode = bufferedOpcode(next_bpc);
+    if (next_opcode < 0) {
+        stats.predecode_not_buffered++;
+        return {0, 0, 0};
+    }
+    auto handler = hdbt.handler(next_opcode);
+    if (handler == 0)
+        handler = dispatch_table[static_cast<std::size_t>(next_opcode)];
+    auto [jump_ip, branch_type] = dispatch_jump[static_cast<std::size_t>(opcode)];
+    if (handler == 0 || jump_ip == 0) {
+        stats.predecode_no_handler++;
+        return {0, 0, 0};
+    }
+    // Handlers sharing one dispatch jump would have the install overwrite the target of the dispatch to this bytecode
+    if (predecode_running >= 0 && dispatch_jump[static_cast<std::size_t>(predecode_running)].first == jump_ip)
+        return {0, 0, 0};
+    stats.predecode_installs++;
+    predecode_installed = {jump_ip, handler};
+    return {jump_ip, branch_type, handler};
+}
+
+void BYTECODE_MODULE::learnDispatch(uint64_t jump_ip, uint8_t branch_type, uint64_t handler)
+{
+    if (predecode_installed.first == jump_ip) {
+        if (predecode_installed.second == handler)
+            stats.predecode_useful++;
+        predecode_installed = {0, 0};
+    }
+    if (predecode_running >= 0)
+        dispatch_jump[static_cast<std::size_t>(predecode_running)] = {jump_ip, branch_type};
+    if (predecode_loaded >= 0)
+        dispatch_table[static_cast<std::size_t>(predecode_loaded)] = handler;
+}
+
+std::pair<int, int> BYTECODE_MODULE::bufferedBytecode(uint64_t bpc)
+{
+    auto const& entry = decode_table[(bpc / BYTECODE_SIZE) % RUNAHEAD_DECODE_SIZE];
+    if (!entry.valid || entry.bpc != bpc || !bb_buffer.inBuffer(bpc))
+        return {-1, 0};
+    return {entry.opcode, entry.oparg};
+}
+
 void BYTECODE_MODULE::generateStats() {
   bb_buffer.generateStats();
   hdbt.generateStats();
+  fusion.generateStats();
   generateDBTBStats();
+  stats.target_predictor = target_predictor;
+  stats.target_predictor_storage_bits = targetPredictorStorageBits();
+  stats.storage = storage();
+  stats.tage_stats = tage.stats;
+  stats.direction_stats = direction.stats;
+  stats.loop_stats = loop.stats;
+  stats.ras_stats = ras.stats;
+  stats.fusion_stats = fusion.stats;
+  stats.l1_stats = bytecode_l1.stats;
 }
 
 void BYTECODE_MODULE::resetStats() {
@@ -49,4 +231,10 @@ void BYTECODE_MODULE::resetStats() {
   bb_buffer.resetStats();
   hdbt.resetStats();
   resetDBTBStats();
+  tage.resetStats();
+  direction.resetStats();
+  loop.resetStats();
+  ras.resetStats();
+  fusion.resetStats();
+  bytecode_l1.resetStats();
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "bytecode_ras.h"
+
+#include "bytecode_buffer.h"
+#include "bytecode_opcodes.h"
+
+namespace
+{
+using namespace bytecode_opcode;
+
+// CALL and its specialisations are followed by four inline cache entries
+constexpr uint64_t CALL_CACHE_ENTRIES = 4;
+} // namespace
+
+BYTECODE_RAS::BYTECODE_RAS(std::size_t ras_depth, RAS_OVERFLOW overflow_policy) : depth(ras_depth), overflow(overflow_policy), stack(ras_depth) {}
+
+bool BYTECODE_RAS::isCall(int opcode)
+{
+  return opcode == CALL || opcode == CALL_ADAPTIVE || opcode == CALL_PY_EXACT_ARGS || opcode == CALL_PY_WITH_DEFAULTS || opcode == CALL_FUNCTION_EX;
+}
+
+bool BYTECODE_RAS::isReturn(int opcode) { return opcode == RETURN_VALUE || opcode == YIELD_VALUE || opcode == SEND; }
+
+uint64_t BYTECODE_RAS::returnOffset(int opcode)
+{
+  if (opcode == CALL_FUNCTION_EX)
+    return BYTECODE_SIZE;
+  return BYTECODE_SIZE * (1 + CALL_CACHE_ENTRIES);
+}
+
+void BYTECODE_RAS::push(uint64_t return_bpc)
+{
+  if (depth == 0)
+    return;
+  stats.pushes++;
+  if (size == depth) {
+    stats.overflows++;
+    if (overflow == RAS_OVERFLOW::DISCARD) {
+      discarded++;
+      return;
+    }
+    size--;
+  }
+  top = (top + 1) % depth;
+  stack[top] = return_bpc;
+  size++;
+}
+
+uint64_t BYTECODE_RAS::pop()
+{
+  if (depth == 0)
+    return 0;
+  if (discarded > 0) {
+    discarded--;
+    return 0;
+  }
+  if (size == 0) {
+    stats.underflows++;
+    return 0;
+  }
+  stats.pops++;
+  auto return_bpc = stack[top];
+  top = (top + depth - 1) % depth;
+  size--;
+  return return_bpc;
+}
+
+void BYTECODE_RAS::popFrameless(uint64_t return_bpc)
+{
+  if (depth == 0)
+    return;
+  stats.frameless_calls++;
+  if (discarded > 0) {
+    discarded--;
+  } else if (size > 0 && stack[top] == return_bpc) {
+    top = (top + depth - 1) % depth;
+    size--;
+  }
+}
+
+uint64_t BYTECODE_RAS::storageBits() const
+{
+  // Return BPCs, the top pointer and the occupancy
+  if (depth == 0)
+    return 0;
+  return depth * 64 + 2 * (champsim::lg2(depth) + 1);
+}
+
+void BYTECODE_RAS::resetStats() { stats = RAS_STATS{}; }
@@ -0,0 +1,160 @@
+#include "bytecode_tage.h"
+
+#include "bytecode_buffer.h"
+#include "util/bits.h"
+
+namespace
+{
+constexpr int TAGE_CTR_MAX = (1 << TAGE_CTR_BITS) - 1;
+constexpr uint8_t TAGE_USEFUL_MAX = (1 << TAGE_USEFUL_BITS) - 1;
+
+uint64_t fold(uint64_t value, std::size_t bits)
+{
+  uint64_t folded = 0;
+  for (; value != 0; value >>= bits)
+    folded ^= value & champsim::bitmask(bits);
+  return folded;
+}
+} // namespace
+
+BYTECODE_TAGE::BYTECODE_TAGE()
+{
+  for (auto& table : tables)
+    table.resize(1ull << TAGE_LOG_ENTRIES);
+}
+
+void BYTECODE_TAGE::pushHistory(int opcode, int64_t jump)
+{
+  history_head = (history_head + 1) % TAGE_MAX_HISTORY;
+  history[history_head] = static_cast<uint16_t>((static_cast<uint64_t>(opcode) << 7) ^ static_cast<uint64_t>(jump / static_cast<int64_t>(BYTECODE_SIZE)));
+  computeHashes();
+}
+
+void BYTECODE_TAGE::computeHashes()
+{
+  // Every table sees the newest TAGE_HISTORY_LENGTHS[i] events, the shorter tables a prefix of the longer ones
+  uint64_t running_index = 0, running_tag = 0;
+  std::size_t table = 0;
+  for (std::size_t age = 0; age < TAGE_MAX_HISTORY && table < TAGE_NUM_TABLES; age++) {
+    auto event = history[(history_head + TAGE_MAX_HISTORY - age) % TAGE_MAX_HISTORY];
+    running_index = (running_index * 0x9E3779B1u) ^ event;
+    running_tag = (running_tag * 0x85EBCA77u) ^ (event + age);
+    if (age + 1 == TAGE_HISTORY_LENGTHS[table]) {
+      index_hash[table] = fold(running_index, TAGE_LOG_ENTRIES);
+      tag_hash[table] = fold(running_tag, TAGE_TAG_BITS);
+      table++;
+    }
+  }
+}
+
+void BYTECODE_TAGE::lookup(int opcode, int oparg, uint64_t bpc)
+{
+  auto pc_bits = (bpc / BYTECODE_SIZE) ^ (static_cast<uint64_t>(opcode) << 3) ^ static_cast<uint64_t>(oparg);
+  provider = -1;
+  alternate = -1;
+  for (std::size_t i = 0; i < TAGE_NUM_TABLES; i++) {
+    last_index[i] = (fold(pc_bits, TAGE_LOG_ENTRIES) ^ index_hash[i] ^ i) & champsim::bitmask(TAGE_LOG_ENTRIES);
+    last_tag[i] = static_cast<uint16_t>((fold(pc_bits * 31, TAGE_TAG_BITS) ^ tag_hash[i]) & champsim::bitmask(TAGE_TAG_BITS));
+    auto const& entry = tables[i][last_index[i]];
+    if (entry.valid && entry.tag == last_tag[i]) {
+      alternate = provider;
+      provider = static_cast<int>(i);
+    }
+  }
+}
+
+int64_t BYTECODE_TAGE::prediction(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc) { return predictionWithConfidence(base, opcode, oparg, bpc).first; }
+
+std::pair<int64_t, int> BYTECODE_TAGE::predictionWithConfidence(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc)
+{
+  lookup(opcode, oparg, bpc);
+  if (provider >= 0) {
+    auto const& entry = tables[provider][last_index[provider]];
+    if (entry.ctr > 0)
+      return {entry.jump, entry.ctr};
+    // A weak provider defers to the next shorter history, or to the DBTB when it is the only match, as update scores it
+    if (alternate >= 0) {
+      auto const& alt = tables[alternate][last_index[alternate]];
+      return {alt.jump, alt.ctr};
+    }
+  }
+  return base.predictionWithConfidence(opcode, oparg);
+}
+
+void BYTECODE_TAGE::update(BYTECODE_BTB& base, int opcode, int oparg, uint64_t bpc, int64_t correct_jump)
+{
+  // The history has not moved since the prediction, so the lookup finds the same entries
+  auto predicted = prediction(base, opcode, oparg, bpc);
+  auto effective = [](int64_t jump) { return jump == 0 ? static_cast<int64_t>(BYTECODE_SIZE) : jump; };
+  bool mispredicted = effective(predicted) != correct_jump;
+
+  if (provider >= 0) {
+    auto& entry = tables[provider][last_index[provider]];
+    auto alt_jump = (alternate >= 0) ? tables[alternate][last_index[alternate]].jump : base.prediction(opcode, oparg);
+    bool provider_correct = entry.jump == correct_jump;
+    bool alt_correct = effective(alt_jump) == correct_jump;
+
+    stats.provider_predictions[provider]++;
+    if (!mispredicted)
+      stats.provider_correct[provider]++;
+
+    if (provider_correct != alt_correct) {
+      if (provider_correct && entry.useful < TAGE_USEFUL_MAX)
+        entry.useful++;
+      else if (!provider_correct && entry.useful > 0)
+        entry.useful--;
+    }
+    if (provider_correct) {
+      if (entry.ctr < TAGE_CTR_MAX)
+        entry.ctr++;
+    } else if (entry.ctr > 0) {
+      entry.ctr--;
+    } else {
+      entry.jump = correct_jump;
+    }
+  } else {
+    stats.base_predictions++;
+    if (!mispredicted)
+      stats.base_correct++;
+  }
+
+  // Allocate a longer history entry on a misprediction
+  if (mispredicted && provider + 1 < static_cast<int>(TAGE_NUM_TABLES)) {
+    auto first = static_cast<std::size_t>(provider + 1);
+    auto free_table = first;
+    while (free_table < TAGE_NUM_TABLES && tables[free_table][last_index[free_table]].useful != 0)
+      free_table++;
+    if (free_table < TAGE_NUM_TABLES) {
+      auto& entry = tables[free_table][last_index[free_table]];
+      entry.tag = last_tag[free_table];
+      entry.jump = correct_jump;
+      entry.ctr = 0;
+      entry.useful = 0;
+      entry.valid = true;
+      stats.allocations++;
+    } else {
+      for (auto i = first; i < TAGE_NUM_TABLES; i++)
+        tables[i][last_index[i]].useful--;
+      stats.failed_allocations++;
+    }
+  }
+
+  // Age the useful counters so that stale entries can be replaced
+  if (++updates % TAGE_USEFUL_RESET_PERIOD == 0) {
+    for (auto& table : tables)
+      for (auto& entry : table)
+        entry.useful >>= 1;
+  }
+
+  base.update(opcode, oparg, correct_jump);
+  pushHistory(opcode, correct_jump);
+}
+
+uint64_t BYTECODE_TAGE::storageBits() const
+{
+  uint64_t entry_bits = 1 + TAGE_TAG_BITS + TAGE_JUMP_BITS + TAGE_CTR_BITS + TAGE_USEFUL_BITS;
+  uint64_t history_bits = TAGE_MAX_HISTORY * 16;
+  return TAGE_NUM_TABLES * (1ull << TAGE_LOG_ENTRIES) * entry_bits + history_bits;
+}
+
+void BYTECODE_TAGE::resetStats() { stats = TAGE_STATS{}; }
@@ -34,13 +34,13 @@
 
 CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me), ld_type(req.ld_type)
+      type(req.type), prefetch_from_this(local_pref), skip_fill(skip || req.skip_fill), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me), ld_type(req.ld_type)
 {
 }
 
 CACHE::mshr_type::mshr_type(tag_lookup_type req, uint64_t cycle)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return), ld_type(req.ld_type)
+      type(req.type), prefetch_from_this(req.prefetch_from_this), skip_fill(req.skip_fill), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return), ld_type(req.ld_type)
 {
 }
 
@@ -58,6 +58,7 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   retval.instr_depend_on_me = merged_instr;
   retval.to_return = merged_return;
   retval.data = predecessor.data;
+  retval.skip_fill = predecessor.skip_fill && successor.skip_fill;
 
   if (predecessor.event_cycle < std::numeric_limits<uint64_t>::max()) {
     retval.event_cycle = predecessor.event_cycle;
@@ -75,7 +76,7 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
 }
 
 CACHE::BLOCK::BLOCK(mshr_type mshr)
-    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data), bytecode(mshr.ld_type == LOAD_TYPE::BLW || mshr.ld_type == LOAD_TYPE::BTG)
+    : valid(true), prefetch(mshr.prefetch_from_this), dirty(mshr.type == access_type::WRITE), address(mshr.address), v_address(mshr.v_address), data(mshr.data), bytecode(mshr.ld_type == LOAD_TYPE::BLW || mshr.ld_type == LOAD_TYPE::BTG), ld_type(mshr.ld_type)
 {
 }
 
@@ -85,8 +86,8 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
 
   // find victim
   auto [set_begin, set_end] = get_set_span(fill_mshr.address);
-  auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
-  if (way == set_end)
+  auto way = fill_mshr.skip_fill ? set_end : std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
+  if (way == set_end && !fill_mshr.skip_fill)
     way = std::next(set_begin, impl_find_victim(fill_mshr.cpu, fill_mshr.instr_id, get_set_index(fill_mshr.address), &*set_begin, fill_mshr.ip,
                                                 fill_mshr.address, champsim::to_underlying(fill_mshr.type)));
   assert(set_begin <= way);
@@ -142,7 +143,7 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
 
       way->pf_metadata = metadata_thru;
     }
-  } else {
+  } else if (!fill_mshr.skip_fill) {
     // Bypass
     assert(fill_mshr.type != access_type::WRITE);
 
@@ -487,6 +488,22 @@ uint64_t CACHE::invalidate_entry(uint64_t inval_addr)
   return std::distance(begin, inv_way);
 }
 
+bool CACHE::probe_virtual(uint64_t v_address) const
+{
+  auto [begin, end] = get_set_span(v_address);
+  return std::any_of(begin, end,
+                     [match = v_address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return entry.valid && (entry.v_address >> shamt) == match; });
+}
+
+void CACHE::bytecode_operate(uint64_t bpc, uint64_t instr_id, int opcode, int oparg, bool lookahead)
+{
+  auto metadata = (static_cast<uint32_t>(opcode) & 0xFF) | static_cast<uint32_t>((static_cast<uint32_t>(oparg) & champsim::bitmask(BYTECODE_HINT_OPARG_BITS)) << 8)
+                  | BYTECODE_HINT_VALID;
+  if (lookahead)
+    metadata |= BYTECODE_HINT_LOOKAHEAD;
+  impl_prefetcher_cache_operate(bpc, bpc, instr_id, false, false, champsim::to_underlying(access_type::LOAD), champsim::to_underlying(LOAD_TYPE::BLW), metadata);
+}
+
 int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, LOAD_TYPE ld_type, uint32_t prefetch_metadata)
 {
   ++sim_stats.pf_requested;
@@ -40,12 +40,96 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
   }
   j = nlohmann::json{{"instructions", stats.instrs()},
                      {"cycles", stats.cycles()},
+                     {"dispatch mode", champsim::dispatch_mode_names.at(champsim::to_underlying(stats.dispatch))},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
                      {"mispredict", mpki},
                      {"seen bytecoes", stats.bytecodes_seen},
                      {"avg bytecode length (ins)", stats.avgInstrPrBytecode()},
                      {"bytecode lengths", bytelengths}
                      };
+  std::vector<nlohmann::json> opcode_cycles;
+  for (auto const& [opcode, cycles] : stats.opcodeCyclesByTotal()) {
+    nlohmann::json entry{{"opcode", opcode < 0 ? "(before first bytecode)" : champsim::plain_printer::getOpcodeName(opcode)},
+                         {"bytecodes", cycles.bytecodes},
+                         {"instructions", cycles.instrs},
+                         {"cycles", cycles.total()}};
+    for (std::size_t cause = 0; cause < std::size(cycle_cause_names); ++cause)
+      entry[std::string{cycle_cause_names[cause]}] = cycles.cycles[cause];
+    opcode_cycles.push_back(entry);
+  }
+  j["opcode cycles"] = opcode_cycles;
+
+  if (!champsim::skips_dispatch(stats.dispatch)) {
+    j["bytecode pre-decode"] = nlohmann::json{{"install", stats.bb_mod.predecode_installs},
+                                              {"useful", stats.bb_mod.predecode_useful},
+                                              {"not buffered", stats.bb_mod.predecode_not_buffered},
+                                              {"no handler", stats.bb_mod.predecode_no_handler}};
+  }
+  if (champsim::skips_dispatch(stats.dispatch)) {
+    auto const& ras = stats.bb_mod.ras_stats;
+    j["bytecode RAS"] = nlohmann::json{{"hit", ras.hits},
+                                       {"miss", ras.miss},
+                                       {"push", ras.pushes},
+                                       {"pop", ras.pops},
+                                       {"overflow", ras.overflows},
+                                       {"underflow", ras.underflows},
+                                       {"frameless call", ras.frameless_calls}};
+
+    auto const& direction = stats.bb_mod.direction_stats;
+    j["bytecode direction"] = nlohmann::json{{"prediction", direction.predictions},
+                                             {"correct", direction.correct},
+                                             {"taken", direction.taken},
+                                             {"predicted taken", direction.predicted_taken}};
+    auto const& loop = stats.bb_mod.loop_stats;
+    j["bytecode loop"] = nlohmann::json{{"override", loop.overrides},
+                                        {"correct", loop.correct},
+                                        {"exit override", loop.exit_overrides},
+                                        {"exit correct", loop.exit_correct},
+                                        {"exit prefetch", loop.exit_prefetches}};
+    auto const& fusion = stats.bb_mod.fusion_stats;
+    std::map<std::string, nlohmann::json> fused_pairs{};
+    for (auto const& pair : fusion.pairStats) {
+      fused_pairs.emplace(fmt::format("{}+{}", pair.first, pair.second),
+                          nlohmann::json{{"fused", pair.fused}, {"instructions saved", pair.instructions_saved}, {"cycles saved", pair.cycles_saved}});
+    }
+    j["bytecode fusion"] = nlohmann::json{{"fused", fusion.fused},
+                                          {"instructions saved", fusion.instructions_saved},
+                                          {"cycles saved", fusion.cycles_saved},
+                                          {"observed pairs", fusion.observed_pairs},
+                                          {"allocations", fusion.allocations},
+                                          {"pairs", fused_pairs}};
+    j["bytecode early restart"] = nlohmann::json{{"restart", stats.bb_stats.early_restarts},
+                                                 {"cycles saved", stats.bb_stats.early_restart_saved},
+                                                 {"average miss wait", stats.bb_stats.averageWaitTime()}};
+    j["bytecode dual path"] = nlohmann::json{{"fetch", stats.bb_stats.dual_path_fetches}, {"used", stats.bb_stats.dual_path_used}};
+    auto const& l1 = stats.bb_mod.l1_stats;
+    j["bytecode L1"] = nlohmann::json{{"hit", l1.hits},
+                                      {"miss", l1.miss},
+                                      {"merged", l1.merged},
+                                      {"mshr full", l1.mshr_full},
+                                      {"average fill latency", l1.fills == 0 ? 0.0 : static_cast<double>(l1.totalFillWait) / static_cast<double>(l1.fills)}};
+    auto const& oparg = stats.bb_mod.dbtb_oparg_stats;
+    j["bytecode BTB oparg level"] = nlohmann::json{{"lookup", oparg.lookups},
+                                                   {"hit", oparg.hits},
+                                                   {"allocation", oparg.allocations},
+                                                   {"eviction", oparg.evictions},
+                                                   {"opcode-only correct", oparg.opcode_only_correct},
+                                                   {"correct", oparg.correct}};
+    auto const& storage = stats.bb_mod.storage;
+    j["bytecode storage bits"] = nlohmann::json{{"BB", storage.bb},
+                                                {"HDBT", storage.hdbt},
+                                                {"target predictor", storage.target_predictor},
+                                                {"RAS", storage.ras},
+                                                {"fusion", storage.fusion},
+                                                {"L1", storage.l1},
+                                                {"decode", storage.decode},
+                                                {"total", storage.total()}};
+    j["bytecode context switch"] = nlohmann::json{{"switch", stats.bb_mod.context_switches},
+                                                  {"retained BB rows", stats.bb_mod.switch_bb_rows},
+                                                  {"retained HDBT entries", stats.bb_mod.switch_hdbt_entries},
+                                                  {"retained DBTB entries", stats.bb_mod.switch_dbtb_entries},
+                                                  {"DBTB slot conflicts", stats.bb_mod.dbtb_slot_conflicts}};
+  }
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type stats)
@@ -63,10 +147,15 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   statsmap.emplace("miss latency", stats.avg_miss_latency);
   statsmap.emplace("bytecode miss latency", stats.avg_miss_latency_bytecode);
   statsmap.emplace("dispatch table miss latency", stats.avg_miss_latency_table);
+  if (auto occupancy = stats.bytecode_occupancy.find(stats.name); occupancy != std::end(stats.bytecode_occupancy))
+    statsmap.emplace("bytecode occupancy", occupancy->second.second == 0 ? 0.0 : occupancy->second.first / occupancy->second.second);
   for (const auto& type : types) {
-    statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
-    statsmap.emplace(type.first, nlohmann::json{{"bytecode hit", stats.bytecode_hits[type.second]}, {"bytecode miss", stats.bytecode_miss[type.second]}});
-    statsmap.emplace(type.first, nlohmann::json{{"dispatch hit", stats.table_hits[type.second]}, {"dispatch miss", stats.table_miss[type.second]}});
+    statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]},
+                                                {"miss", stats.misses[type.second]},
+                                                {"bytecode hit", stats.bytecode_hits[type.second]},
+                                                {"bytecode miss", stats.bytecode_miss[type.second]},
+                                                {"dispatch hit", stats.table_hits[type.second]},
+                                                {"dispatch miss", stats.table_miss[type.second]}});
   }
 
   j = statsmap;
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -45,6 +46,9 @@ int main(int argc, char** argv)
   bool knob_bytecode{false};
   uint64_t warmup_instructions = 0;
   uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
+  uint64_t scheduler_quantum = 1000000;
+  champsim::dispatch_mode dispatch_mode = champsim::dispatch_mode::SKIP;
+  BB_FILL_LEVEL fill_level = BB_FILL_LEVEL::L1I;
   std::string json_file_name;
   std::vector<std::string> trace_names;
 
@@ -67,7 +71,37 @@ int main(int argc, char** argv)
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  app.add_option("--scheduler-quantum", scheduler_quantum, "The number of instructions a trace runs for before the next trace on its core is scheduled")
+      ->capture_default_str()
+      ->check(CLI::PositiveNumber);
+
+  std::map<std::string, champsim::dispatch_mode> dispatch_modes;
+  for (std::size_t mode = 0; mode < std::size(champsim::dispatch_mode_names); ++mode)
+    dispatch_modes.emplace(champsim::dispatch_mode_names.at(mode), static_cast<champsim::dispatch_mode>(mode));
+  app.add_option("--dispatch-mode", dispatch_mode, "How the cores handle the interpreter's dispatch: no-skip, skip (the default), ideal or minimal")
+      ->transform(CLI::CheckedTransformer(dispatch_modes, CLI::ignore_case));
+
+  std::map<std::string, BB_FILL_LEVEL> fill_levels;
+  for (std::size_t level = 0; level < std::size(bb_fill_level_names); ++level)
+    fill_levels.emplace(bb_fill_level_names.at(level), static_cast<BB_FILL_LEVEL>(level));
+  auto fill_level_option = app.add_option("--fill-level", fill_level, "The cache the BB fetches rows from: L1I, L1D or L2C. If not specified, the configured one")
+                               ->transform(CLI::CheckedTransformer(fill_levels, CLI::ignore_case));
+
+  // A comma separated list of traces is interleaved on its core
+  auto existing_trace_files = CLI::Validator(
+      [](std::string& names) {
+        std::string error;
+        for (std::size_t begin = 0, end = 0; end != std::string::npos && std::empty(error); begin = end + 1) {
+          end = names.find(',', begin);
+          error = CLI::ExistingFile(names.substr(begin, end - begin));
+        }
+        return error;
+      },
+      "FILE[,FILE...]");
+  app.add_option("traces", trace_names, "The paths to the traces, a comma separated list runs several traces on one core as threads sharing an address space")
+      ->required()
+      ->expected(NUM_CPUS)
+      ->check(existing_trace_files);
 
   CLI11_PARSE(app, argc, argv);
 
@@ -83,10 +117,27 @@ int main(int argc, char** argv)
   if (simulation_given && !warmup_given)
     warmup_instructions = simulation_instructions * 2 / 10;
 
+  // Set before the cores are initialized, which sizes their BTBs for the mode
+  for (O3_CPU& cpu : gen_environment.cpu_view()) {
+    cpu.dispatch = dispatch_mode;
+    if (fill_level_option->count() > 0)
+      cpu.BB_FILL_FROM = fill_level;
+  }
+
   std::vector<champsim::tracereader> traces;
   std::transform(
       std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
-      [knob_cloudsuite, knob_bytecode, repeat = simulation_given, i = uint8_t(0)](auto name) mutable { return get_tracereader(name, i++, knob_cloudsuite, knob_bytecode, repeat); });
+      [knob_cloudsuite, knob_bytecode, scheduler_quantum, repeat = simulation_given, i = uint8_t(0)](auto name) mutable {
+        auto cpu = i++;
+        if (name.find(',') == std::string::npos)
+          return get_tracereader(name, cpu, knob_cloudsuite, knob_bytecode, repeat);
+        std::vector<champsim::tracereader> threads;
+        for (std::size_t begin = 0, end = 0; end != std::string::npos; begin = end + 1) {
+          end = name.find(',', begin);
+          threads.push_back(get_tracereader(name.substr(begin, end - begin), cpu, knob_cloudsuite, knob_bytecode, repeat));
+        }
+        return champsim::tracereader{champsim::multiplexed_tracereader{std::move(threads), scheduler_quantum}};
+      });
 
   std::vector<champsim::phase_info> phases{
       {champsim::phase_info{"Warmup", true, warmup_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names},
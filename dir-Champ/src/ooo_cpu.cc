@@ -36,20 +36,23 @@ long O3_CPU::operate()
 {
   long progress{0};
 
-  progress += retire_rob();                    // retire
-  progress += complete_inflight_instruction(); // finalize execution
-  progress += execute_instruction();           // execute instructions
-  progress += schedule_instruction();          // schedule instructions
-  progress += handle_memory_return();          // finalize memory transactions
-  progress += operate_lsq();                   // execute memory transactions
+  auto retired = retire_rob();                 // retire
+  progress += retired;
+  if (retired == 0)
+    account_stall_cycle();
+  progress += complete_inflight_instruction();      // finalize execution
+  progress += execute_instruction();                // execute instructions
+  progress += schedule_instruction();               // schedule instructions
+  progress += (this->*handle_memory_return_stage)(); // finalize memory transactions
+  progress += (this->*operate_lsq_stage)();          // execute memory transactions
 
   progress += dispatch_instruction(); // dispatch
   progress += decode_instruction();   // decode
   progress += promote_to_decode();
 
   progress += fetch_instruction(); // fetch
-  progress += check_dib();
-  initialize_instruction();
+  progress += (this->*check_dib_stage)();
+  (this->*initialize_instruction_stage)();
 
   // heartbeat
   if (show_heartbeat && (num_retired >= next_print_instruction)) {
@@ -76,8 +79,20 @@ void O3_CPU::initialize()
 {
   // BRANCH PREDICTOR & BTB
   impl_initialize_branch_predictor();
+  // The indirect BTB gives up what the bytecode structures in use take
+  bytecode_module.setDispatch(dispatch, BB_PREDECODE, BB_OPERAND_HINTS);
   impl_initialize_btb();
   bytecode_module.initialize(cpu);
+  select_dispatch_stages();
+
+  fmt::print("CPU {} dispatch mode: {}\n", cpu, champsim::dispatch_mode_names.at(champsim::to_underlying(dispatch)));
+  if (skips_dispatch()) {
+    auto storage = bytecode_module.storage();
+    fmt::print("CPU {} bytecode storage bits, BB: {} HDBT: {} target predictor: {} RAS: {} fusion: {} L1: {} decode: {} total: {} ({:.2f} KB)\n", cpu,
+               storage.bb, storage.hdbt, storage.target_predictor, storage.ras, storage.fusion, storage.l1, storage.decode, storage.total(),
+               storage.total() / 8192.0);
+    fmt::print("CPU {} BB fill level: {}\n", cpu, bb_fill_level_names.at(champsim::to_underlying(BB_FILL_FROM)));
+  }
 }
 
 void O3_CPU::begin_phase()
@@ -90,9 +105,41 @@ void O3_CPU::begin_phase()
   stats.name = "CPU " + std::to_string(cpu);
   stats.begin_instrs = num_retired;
   stats.begin_cycles = current_cycle;
+  stats.dispatch = dispatch;
   sim_stats = stats;
 
   bytecode_module.resetStats();
+  select_dispatch_stages();
+}
+
+void O3_CPU::select_dispatch_stages()
+{
+  switch (dispatch) {
+  case champsim::dispatch_mode::NO_SKIP:
+    initialize_instruction_stage = &O3_CPU::initialize_instruction<champsim::dispatch_mode::NO_SKIP>;
+    check_dib_stage = &O3_CPU::check_dib<champsim::dispatch_mode::NO_SKIP>;
+    operate_lsq_stage = &O3_CPU::operate_lsq<champsim::dispatch_mode::NO_SKIP>;
+    handle_memory_return_stage = &O3_CPU::handle_memory_return<champsim::dispatch_mode::NO_SKIP>;
+    break;
+  case champsim::dispatch_mode::SKIP:
+    initialize_instruction_stage = &O3_CPU::initialize_instruction<champsim::dispatch_mode::SKIP>;
+    check_dib_stage = &O3_CPU::check_dib<champsim::dispatch_mode::SKIP>;
+    operate_lsq_stage = &O3_CPU::operate_lsq<champsim::dispatch_mode::SKIP>;
+    handle_memory_return_stage = &O3_CPU::handle_memory_return<champsim::dispatch_mode::SKIP>;
+    break;
+  case champsim::dispatch_mode::IDEAL:
+    initialize_instruction_stage = &O3_CPU::initialize_instruction<champsim::dispatch_mode::IDEAL>;
+    check_dib_stage = &O3_CPU::check_dib<champsim::dispatch_mode::IDEAL>;
+    operate_lsq_stage = &O3_CPU::operate_lsq<champsim::dispatch_mode::IDEAL>;
+    handle_memory_return_stage = &O3_CPU::handle_memory_return<champsim::dispatch_mode::IDEAL>;
+    break;
+  case champsim::dispatch_mode::MINIMAL:
+    initialize_instruction_stage = &O3_CPU::initialize_instruction<champsim::dispatch_mode::MINIMAL>;
+    check_dib_stage = &O3_CPU::check_dib<champsim::dispatch_mode::MINIMAL>;
+    operate_lsq_stage = &O3_CPU::operate_lsq<champsim::dispatch_mode::MINIMAL>;
+    handle_memory_return_stage = &O3_CPU::handle_memory_return<champsim::dispatch_mode::MINIMAL>;
+    break;
+  }
 }
 
 void O3_CPU::end_phase(unsigned finished_cpu)
@@ -115,22 +162,34 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
+template <champsim::dispatch_mode MODE>
 void O3_CPU::initialize_instruction()
 {
+  constexpr bool skip = champsim::skips_dispatch(MODE);
+  constexpr bool ideal = (MODE == champsim::dispatch_mode::IDEAL);
+  // Fusion and the bytecode prefetchers only run in the full skip mode
+  constexpr bool skip_helpers = (MODE == champsim::dispatch_mode::SKIP);
+
   auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
 
   while (current_cycle >= fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(input_queue)) {
     instrs_to_read_this_cycle--;
-    if constexpr (champsim::skip_dispatch) {
+    if constexpr (skip) {
       if (input_queue.front().ld_type == load_type::INITIAL || input_queue.front().ld_type == load_type::BLW) {
         reorder_queues();
       }
     }
 
     ooo_model_instr queue_front = input_queue.front();
+    if (queue_front.ld_type == load_type::BLW) {
+      fetch_opcode = static_cast<int>(queue_front.load_val & 0xFF);
+      ++sim_stats.opcodeCycles(fetch_opcode).bytecodes;
+    }
+    queue_front.bytecode_opcode = fetch_opcode;
+    queue_front.hdbt_miss_dispatch = queue_front.instr_id < hdbt_miss_dispatch_end;
     auto stop_fetch = do_init_instruction(queue_front);
 
-    if constexpr (champsim::skip_dispatch) {
+    if constexpr (skip) {
       // Add to IFETCH_BUFFER
       if (queue_front.ld_type != load_type::BLW) {
         IFETCH_BUFFER.push_back(queue_front);
@@ -147,12 +206,17 @@ void O3_CPU::initialize_instruction()
         if (queue_front.load_size != 8) {
           instr_oparg = (queue_front.load_val >> 8);
         }
-        bool hitInBB = bytecode_module.bb_buffer.hitInBB(bytecode_pc);
-        bool correctPrediction = false;
+        bytecode_module.switchContext(queue_front.asid[0]);
+        bytecode_module.recordBytecode(bytecode_pc, instr_opcode, instr_oparg);
+        // The ideal front end always holds the bytecode, predicts its successor and has its handler
+        bool hitInBB = ideal || bytecode_module.bb_buffer.hitInBB(bytecode_pc);
+        bool correctPrediction = ideal;
         bool shouldFetch = false;
         auto target = find_skip_target(queue_front);
         uint64_t predicted_next_bpc = bytecode_pc + BYTECODE_SIZE * BYTECODE_FETCH_TIME;
-        if (hitInBB) {
+        if constexpr (ideal) {
+          sim_stats.hitsAndMissesAtPC[queue_front.ip].second++;
+        } else if (hitInBB) {
           sim_stats.hitsAndMissesAtPC[queue_front.ip].second++;
           if (target != nullptr) {
             correctPrediction = bytecode_module.correctPrediction(bytecode_pc);
@@ -181,9 +245,28 @@ void O3_CPU::initialize_instruction()
           }
         }
 
-        if (target != nullptr) {
+        bool fused = skip_helpers && bytecode_module.fusion.dispatch(bytecode_pc, instr_opcode, target != nullptr);
+        if (fused) {
+          // The previous handler ran this bytecode as the second half of a fused pair, so its dispatch is
+          // neither looked up in the HDBT nor redirects fetch. Charge the pair with what an unfused
+          // dispatch would have cost: the fetch redirect, fetching the dispatch on an HDBT miss, and a
+          // BPC mispredict
+          auto skipped_before = sim_stats.skipped_instrs;
+          bool hdbt_would_hit = bytecode_module.hdbt.contains(instr_opcode);
+          skip_forward(*target);
+          auto dispatch_instrs = sim_stats.skipped_instrs - skipped_before;
+          uint64_t cycles_saved = hdbt_would_hit ? 1 : static_cast<uint64_t>((static_cast<long>(dispatch_instrs) + FETCH_WIDTH - 1) / FETCH_WIDTH);
+          if (hdbt_would_hit && !correctPrediction)
+            cycles_saved += BYTECODE_BRANCH_MISPREDICT_PENALTY;
+          bytecode_module.fusion.recordSavings(hdbt_would_hit ? 0 : dispatch_instrs, cycles_saved);
+        } else if (target != nullptr) {
+          bool hdbt_hit = ideal || bytecode_module.hdbt.hit(instr_opcode);
+          // The skip target is the handler entry point, from the BTG load value or the JUMP_POINT target
+          bytecode_module.hdbt.learnHandler(instr_opcode, target->ip);
+          if (bytecode_module.hdbt.coveredDispatch(target->ip) && !l1i->probe_virtual(target->ip))
+            bytecode_module.hdbt.stats.late++;
           // STOP FETCHING AS THIS IS BRANCHING TYPE
-          if (bytecode_module.hdbt.hit(instr_opcode)) {
+          if (hdbt_hit) {
             if (!correctPrediction && queue_front.ld_type == load_type::BLW) {
               queue_front.ld_type = load_type::MISS_BPC_PRED;
               miss_BPC_cycle = this->current_cycle;
@@ -195,6 +278,7 @@ void O3_CPU::initialize_instruction()
             stop_fetch = true;
             skip_forward(*target);
           } else {
+            hdbt_miss_dispatch_end = target->instr_id;
             input_queue.pop_front();
           }
 
@@ -207,19 +291,33 @@ void O3_CPU::initialize_instruction()
           // dependencies from this instruction, as the dependency is handled on the BB side
           bytecode_module.bb_buffer.fetching(fetch_pc, this->current_cycle, hitInBB);
           sim_stats.bytecode_fetches[hitInBB]++;
-          CacheBus::request_type fetch_packet;
-          fetch_packet.v_address = fetch_pc;
-          fetch_packet.instr_id = input_queue.front().instr_id;
-          fetch_packet.ip = fetch_pc;
-          fetch_packet.instr_depend_on_me = {};
-          fetch_packet.ld_type = LOAD_TYPE::BLW;
-          if (!L1I_bus.issue_read(fetch_packet))
+          if (!issue_bytecode_fetch(fetch_pc, input_queue.front().instr_id))
             fmt::print(stderr, "Issue when fetching bytecode \n");
         }
+        if constexpr (skip_helpers) {
+          if (hitInBB && target != nullptr && bytecode_module.bb_buffer.dual_path_confidence > 0) {
+            fetch_dual_path(bytecode_pc, instr_opcode, instr_oparg, predicted_next_bpc, queue_front.instr_id);
+          }
+          if (hitInBB && bytecode_module.bb_buffer.runahead_depth > 0) {
+            runahead_bytecode_fetch(bytecode_pc, predicted_next_bpc, queue_front.instr_id);
+          }
+          if (hitInBB && target != nullptr && bytecode_module.hdbt.prefetch_depth > 0) {
+            prefetch_next_handler(predicted_next_bpc);
+          }
+          if (hitInBB && target != nullptr) {
+            auto exit_bpc = bytecode_module.loopExitPrefetch(bytecode_pc, instr_opcode);
+            if (exit_bpc != 0 && bytecode_module.bb_buffer.shouldFetch(exit_bpc))
+              prefetch_loop_exit(exit_bpc, queue_front.instr_id);
+          }
+          if (BB_OPERAND_HINTS)
+            hint_operand_prefetch(bytecode_pc, instr_opcode, instr_oparg, predicted_next_bpc, queue_front.instr_id);
+        }
       }
     }
 
-    if constexpr (!champsim::skip_dispatch) {
+    if constexpr (!skip) {
+      if (BB_PREDECODE)
+        predecode_bytecode(queue_front);
       IFETCH_BUFFER.push_back(queue_front);
       input_queue.pop_front();
     }
@@ -231,6 +329,92 @@ void O3_CPU::initialize_instruction()
   }
 }
 
+bool O3_CPU::issue_bytecode_fetch(uint64_t bpc, uint64_t instr_id)
+{
+  // BB fills are served by the bytecode L1 first, only its misses go out to the fill level
+  auto& bytecode_l1 = bytecode_module.bytecode_l1;
+  if (bytecode_l1.enabled() && bytecode_l1.access(bpc, this->current_cycle))
+    return true;
+
+  CacheBus::request_type fetch_packet;
+  fetch_packet.v_address = bpc;
+  fetch_packet.instr_id = instr_id;
+  fetch_packet.ip = bpc;
+  fetch_packet.instr_depend_on_me = {};
+  fetch_packet.ld_type = LOAD_TYPE::BLW;
+  // L2C fills go through the L1I tags, a hit there is used, but a miss does not allocate in the L1I
+  fetch_packet.skip_fill = (BB_FILL_FROM == BB_FILL_LEVEL::L2C);
+  auto& fill_bus = (BB_FILL_FROM == BB_FILL_LEVEL::L1D) ? L1D_bus : L1I_bus;
+  if (!fill_bus.issue_read(fetch_packet))
+    return false;
+  if (bytecode_l1.enabled())
+    bytecode_l1.allocate(bpc, this->current_cycle);
+  return true;
+}
+
+void O3_CPU::predecode_bytecode(const ooo_model_instr& instr)
+{
+  // Without skipping, every dispatch jump goes through the BTB. The bytecode loads fill the BB, and the
+  // pre-decoder reads the bytecode predicted after the loaded one out of it, so the jump at the end of
+  // the loaded bytecode's handler finds its target installed before it is fetched
+  if (instr.ld_type == load_type::BLW) {
+    auto& bb_buffer = bytecode_module.bb_buffer;
+    uint64_t bpc = instr.source_memory.front();
+    int opcode = instr.load_val & 0xFF;
+    int oparg = (instr.load_size != 8) ? static_cast<int>(instr.load_val >> 8) : 0;
+    bytecode_module.switchContext(instr.asid[0]);
+    bytecode_module.recordBytecode(bpc, opcode, oparg);
+    if (!bb_buffer.hitInBB(bpc)) {
+      if (bb_buffer.shouldFetch(bpc))
+        bb_buffer.fetching(bpc, this->current_cycle, false);
+      if (bb_buffer.blockIsNeeded(bpc))
+        bb_buffer.updateBufferEntries(bpc, this->current_cycle);
+    }
+    auto [jump_ip, branch_type, handler] = bytecode_module.predecode(bpc, opcode, oparg);
+    if (jump_ip != 0)
+      impl_update_btb(jump_ip, handler, true, branch_type);
+  } else if (instr.ld_type == load_type::JUMP_POINT || instr.ld_type == load_type::COMBINED_JUMP) {
+    bytecode_module.learnDispatch(instr.ip, instr.branch_type, instr.branch_target);
+  }
+}
+
+void O3_CPU::fetch_dual_path(uint64_t bytecode_pc, int opcode, int oparg, uint64_t predicted_next_bpc, uint64_t instr_id)
+{
+  // A low confidence conditional bytecode also fetches the successor that was not predicted, but only
+  // into a row that holds neither the bytecode itself nor the predicted successor
+  auto& bb_buffer = bytecode_module.bb_buffer;
+  auto alternate_bpc = bytecode_module.dualPathTarget(bytecode_pc, opcode, oparg, predicted_next_bpc);
+  if (alternate_bpc == 0 || !bb_buffer.shouldFetch(alternate_bpc))
+    return;
+  protected_bpcs.assign({bytecode_pc, predicted_next_bpc});
+  if (!bb_buffer.protectedVictimAvailable(protected_bpcs))
+    return;
+  if (!issue_bytecode_fetch(alternate_bpc, instr_id))
+    return;
+  bb_buffer.dualPathFetching(alternate_bpc, this->current_cycle, protected_bpcs);
+  bytecode_module.dualPathFetched(alternate_bpc);
+}
+
+void O3_CPU::runahead_bytecode_fetch(uint64_t bytecode_pc, uint64_t predicted_next_bpc, uint64_t instr_id)
+{
+  // Follow the predicted bytecode path and fill the rows it needs that are not in the BB.
+  // Rows already on the path are protected from being used as victims.
+  auto& bb_buffer = bytecode_module.bb_buffer;
+  protected_bpcs.assign(1, bytecode_pc);
+  uint64_t bpc = predicted_next_bpc;
+  for (std::size_t depth = 0; depth < bb_buffer.runahead_depth && bpc != 0; depth++) {
+    protected_bpcs.push_back(bpc);
+    if (!bb_buffer.inBufferOrFetching(bpc)) {
+      if (!bb_buffer.protectedVictimAvailable(protected_bpcs))
+        return;
+      if (!issue_bytecode_fetch(bpc, instr_id))
+        return;
+      bb_buffer.runaheadFetching(bpc, this->current_cycle, protected_bpcs);
+    }
+    bpc = bytecode_module.runaheadNext(bpc, bb_buffer.runahead_confidence);
+  }
+}
+
 ooo_model_instr* O3_CPU::find_skip_target(const ooo_model_instr& queue_front)
 {
   load_type last_ld_type = load_type::NOT_IMPLEMENTED;
@@ -451,6 +635,52 @@ void O3_CPU::reorder_queues()
   }
 }
 
+void O3_CPU::prefetch_next_handler(uint64_t predicted_next_bpc)
+{
+  // The BB already holds the next bytecode, so its handler is known before it dispatches
+  auto& hdbt = bytecode_module.hdbt;
+  auto opcode = bytecode_module.bufferedOpcode(predicted_next_bpc);
+  if (opcode < 0)
+    return;
+  auto handler = hdbt.handler(opcode);
+  if (handler == 0)
+    return;
+  for (std::size_t line = 0; line < hdbt.prefetch_depth; line++)
+    l1i->prefetch_line(((handler >> LOG2_BLOCK_SIZE) + line) << LOG2_BLOCK_SIZE, true, 0);
+  hdbt.prefetchedHandler(handler);
+}
+
+void O3_CPU::prefetch_loop_exit(uint64_t exit_bpc, uint64_t instr_id)
+{
+  // The loop predictor knows the exit is a few iterations away, fetch its row before the loop is left
+  if (!issue_bytecode_fetch(exit_bpc, instr_id))
+    return;
+  bytecode_module.bb_buffer.fetching(exit_bpc, this->current_cycle, true);
+  bytecode_module.loopExitPrefetched();
+}
+
+void O3_CPU::hint_filled_operands(uint64_t v_address)
+{
+  // The bytecodes of a row are decoded as it fills, long before their handlers run. Their operand loads follow
+  // from the opcode and oparg, so they are prefetched from here
+  auto block = (v_address >> LOG2_BLOCK_SIZE) << LOG2_BLOCK_SIZE;
+  for (auto bpc = block; bpc < block + BLOCK_SIZE; bpc += BYTECODE_SIZE) {
+    auto [opcode, oparg] = bytecode_module.bufferedBytecode(bpc);
+    if (opcode >= 0)
+      l1d->bytecode_operate(bpc, 0, opcode, oparg, true);
+  }
+}
+
+void O3_CPU::hint_operand_prefetch(uint64_t bytecode_pc, int opcode, int oparg, uint64_t predicted_next_bpc, uint64_t instr_id)
+{
+  // The BLW attributes the handler's loads to the bytecode, and prefetches what the fill could not, a bytecode
+  // the decode table did not know yet
+  l1d->bytecode_operate(bytecode_pc, instr_id, opcode, oparg, false);
+  auto [next_opcode, next_oparg] = bytecode_module.bufferedBytecode(predicted_next_bpc);
+  if (next_opcode >= 0)
+    l1d->bytecode_operate(predicted_next_bpc, instr_id, next_opcode, next_oparg, true);
+}
+
 // Skips forward until target instr, removing every instruction until that point from the queue
 void O3_CPU::skip_forward(ooo_model_instr const& target_instr)
 {
@@ -545,15 +775,17 @@ bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
   return do_predict_branch(arch_instr);
 }
 
+template <champsim::dispatch_mode MODE>
 long O3_CPU::check_dib()
 {
   // scan through IFETCH_BUFFER to find instructions that hit in the decoded instruction buffer
   auto begin = std::find_if(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), [](const ooo_model_instr& x) { return !x.dib_checked; });
   auto [window_begin, window_end] = champsim::get_span(begin, std::end(IFETCH_BUFFER), FETCH_WIDTH);
-  std::for_each(window_begin, window_end, [this](auto& ifetch_entry) { this->do_check_dib(ifetch_entry); });
+  std::for_each(window_begin, window_end, [this](auto& ifetch_entry) { this->do_check_dib<MODE>(ifetch_entry); });
   return std::distance(window_begin, window_end);
 }
 
+template <champsim::dispatch_mode MODE>
 void O3_CPU::do_check_dib(ooo_model_instr& instr)
 {
   // Check DIB to see if we recently fetched this line
@@ -561,7 +793,8 @@ void O3_CPU::do_check_dib(ooo_model_instr& instr)
     // The cache line is in the L0, so we can mark this as complete
     instr.fetched = COMPLETED;
 
-    if constexpr (champsim::skip_dispatch) {
+    // The ideal front end never waits on the BB
+    if constexpr (champsim::skips_dispatch(MODE) && MODE != champsim::dispatch_mode::IDEAL) {
       // return result of fetching bytecode instructions to the Bytecode buffer
       if (instr.ld_type == load_type::BLW) {
         bool foundCurrNeeded = bytecode_module.bb_buffer.updateBufferEntries(instr.ip, this->current_cycle);
@@ -610,7 +843,10 @@ long O3_CPU::fetch_instruction()
     // Issue to L1I
     auto success = do_fetch_instruction(l1i_req_begin, l1i_req_end);
     if (success) {
-      std::for_each(l1i_req_begin, l1i_req_end, [](auto& x) { x.fetched = INFLIGHT; });
+      std::for_each(l1i_req_begin, l1i_req_end, [cycle = current_cycle](auto& x) {
+        x.fetched = INFLIGHT;
+        x.fetch_issue_cycle = cycle;
+      });
       ++progress;
     }
 
@@ -840,13 +1076,14 @@ void O3_CPU::do_memory_scheduling(ooo_model_instr& instr)
   }
 }
 
+template <champsim::dispatch_mode MODE>
 long O3_CPU::operate_lsq()
 {
   auto store_bw = SQ_WIDTH;
 
   const auto complete_id = std::empty(ROB) ? std::numeric_limits<uint64_t>::max() : ROB.front().instr_id;
   auto do_complete = [cycle = current_cycle, complete_id, this](const auto& x) {
-    return x.instr_id < complete_id && x.event_cycle <= cycle && this->do_complete_store(x);
+    return x.instr_id < complete_id && x.event_cycle <= cycle && this->do_complete_store<MODE>(x);
   };
 
   auto unfetched_begin = std::partition_point(std::begin(SQ), std::end(SQ), [](const auto& x) { return x.fetch_issued; });
@@ -872,6 +1109,7 @@ long O3_CPU::operate_lsq()
       if (success) {
         --load_bw;
         lq_entry->fetch_issued = true;
+        lq_entry->issue_cycle = current_cycle;
         if (lq_entry->ld_type == LOAD_TYPE::MISS_BPC_PRED) {
           lq_entry->finish(ROB.begin(), ROB.end());
           lq_entry.reset();
@@ -897,6 +1135,7 @@ void O3_CPU::do_finish_store(const LSQ_ENTRY& sq_entry)
   }
 }
 
+template <champsim::dispatch_mode MODE>
 bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
 {
   CacheBus::request_type data_packet;
@@ -908,7 +1147,12 @@ bool O3_CPU::do_complete_store(const LSQ_ENTRY& sq_entry)
     fmt::print("[SQ] {} instr_id: {} vaddr: {:x}\n", __func__, data_packet.instr_id, data_packet.v_address);
   }
 
-  return L1D_bus.issue_write(data_packet);
+  auto success = L1D_bus.issue_write(data_packet);
+  if constexpr (champsim::skips_dispatch(MODE)) {
+    if (success)
+      bytecode_module.snoopStore(sq_entry.virtual_address, BB_STORE_BYTES);
+  }
+  return success;
 }
 
 bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
@@ -966,32 +1210,71 @@ long O3_CPU::complete_inflight_instruction()
   return EXEC_WIDTH - complete_bw;
 }
 
+template <champsim::dispatch_mode MODE>
+void O3_CPU::fill_bytecode_buffer(uint64_t v_address)
+{
+  auto& bb_buffer = bytecode_module.bb_buffer;
+  if (!bb_buffer.blockIsNeeded(v_address))
+    return;
+  bool foundCurrFetching = bb_buffer.updateBufferEntries(v_address, this->current_cycle);
+  // A store hit the missed bytecode's row while its block was in flight, the block came back stale and is fetched again
+  if (!foundCurrFetching && bb_buffer.currFetching.first && bb_buffer.shouldFetch(bb_buffer.currFetching.second)) {
+    bb_buffer.fetching(bb_buffer.currFetching.second, this->current_cycle, false);
+    if (!issue_bytecode_fetch(bb_buffer.currFetching.second, std::empty(input_queue) ? 0 : input_queue.front().instr_id))
+      fmt::print(stderr, "Issue when fetching bytecode \n");
+  }
+  if constexpr (MODE == champsim::dispatch_mode::SKIP) {
+    if (BB_OPERAND_HINTS)
+      hint_filled_operands(v_address);
+  }
+  if (foundCurrFetching && bb_buffer.currFetching.first) {
+    if (bytecode_buffer_miss && fetch_resume_cycle > this->current_cycle) {
+      restart_bytecode_fetch();
+    } else {
+      if (bytecode_buffer_miss) {
+        fmt::print(stderr, "Possible problem on miss outside loop: {:x} \n", v_address);
+        bytecode_module.bb_buffer.printInterestingThings();
+      }
+      if (fetch_resume_cycle >= this->current_cycle) {
+        fmt::print(stderr, "Possible problem on cycle outside loop {:x} \n", v_address);
+        bytecode_module.bb_buffer.printInterestingThings();
+      }
+    }
+  }
+}
+
+void O3_CPU::restart_bytecode_fetch()
+{
+  fetch_resume_cycle = this->current_cycle;
+  bytecode_buffer_miss = false;
+  bytecode_module.bb_buffer.currFetching.first = false;
+}
+
+template <champsim::dispatch_mode MODE>
 long O3_CPU::handle_memory_return()
 {
+  constexpr bool skip = champsim::skips_dispatch(MODE);
   long progress{0};
 
+  // Rows whose block has returned are written a few bytecodes per cycle, the missed one may be among them
+  if (skip || BB_PREDECODE) {
+    if (bytecode_module.bb_buffer.writeRows(this->current_cycle) && bytecode_buffer_miss && fetch_resume_cycle > this->current_cycle)
+      restart_bytecode_fetch();
+  }
+
+  if constexpr (skip) {
+    // Bytecode L1 hits whose latency has passed fill the BB like an L1I return
+    for (auto v_address = bytecode_module.bytecode_l1.nextHit(this->current_cycle); v_address != 0;
+         v_address = bytecode_module.bytecode_l1.nextHit(this->current_cycle))
+      fill_bytecode_buffer<MODE>(v_address);
+  }
+
   for (auto l1i_bw = FETCH_WIDTH, to_read = L1I_BANDWIDTH; l1i_bw > 0 && to_read > 0 && !L1I_bus.lower_level->returned.empty(); --to_read) {
     auto& l1i_entry = L1I_bus.lower_level->returned.front();
-    if constexpr (champsim::skip_dispatch) {
-      if (bytecode_module.bb_buffer.blockIsNeeded(l1i_entry.v_address)) {
-        bool foundCurrFetching = bytecode_module.bb_buffer.updateBufferEntries(l1i_entry.v_address, this->current_cycle);
-        if (foundCurrFetching && bytecode_module.bb_buffer.currFetching.first) {
-          if (bytecode_buffer_miss && fetch_resume_cycle > this->current_cycle) {
-            fetch_resume_cycle = this->current_cycle;
-            bytecode_buffer_miss = false;
-            bytecode_module.bb_buffer.currFetching.first = false;
-          } else {
-            if (bytecode_buffer_miss) {
-              fmt::print(stderr, "Possible problem on miss outside loop: {:x} \n", l1i_entry.v_address);
-              bytecode_module.bb_buffer.printInterestingThings();
-            }
-            if (fetch_resume_cycle >= this->current_cycle) {
-              fmt::print(stderr, "Possible problem on cycle outside loop {:x} \n", l1i_entry.v_address);
-              bytecode_module.bb_buffer.printInterestingThings();
-            }
-          }
-        }
-      }
+    if constexpr (skip) {
+      if (bytecode_module.bytecode_l1.enabled())
+        bytecode_module.bytecode_l1.fill(l1i_entry.v_address, this->current_cycle);
+      fill_bytecode_buffer<MODE>(l1i_entry.v_address);
     }
     while (l1i_bw > 0 && !l1i_entry.instr_depend_on_me.empty()) {
       ooo_model_instr& fetched = l1i_entry.instr_depend_on_me.front();
@@ -1015,6 +1298,13 @@ long O3_CPU::handle_memory_return()
 
   auto l1d_it = std::begin(L1D_bus.lower_level->returned);
   for (auto l1d_bw = L1D_BANDWIDTH; l1d_bw > 0 && l1d_it != std::end(L1D_bus.lower_level->returned); --l1d_bw, ++l1d_it) {
+    if constexpr (skip) {
+      if (BB_FILL_FROM == BB_FILL_LEVEL::L1D) {
+        if (bytecode_module.bytecode_l1.enabled())
+          bytecode_module.bytecode_l1.fill(l1d_it->v_address, this->current_cycle);
+        fill_bytecode_buffer<MODE>(l1d_it->v_address);
+      }
+    }
     for (auto& lq_entry : LQ) {
       if (lq_entry.has_value() && lq_entry->fetch_issued && lq_entry->virtual_address >> LOG2_BLOCK_SIZE == l1d_it->v_address >> LOG2_BLOCK_SIZE) {
         lq_entry->finish(std::begin(ROB), std::end(ROB));
@@ -1040,11 +1330,54 @@ long O3_CPU::retire_rob()
   }
   auto retire_count = std::distance(retire_begin, retire_end);
   num_retired += retire_count;
+  std::for_each(retire_begin, retire_end, [this](const auto& x) { ++sim_stats.opcodeCycles(x.bytecode_opcode).instrs; });
+  if (retire_count > 0) {
+    auto cause = retire_begin->hdbt_miss_dispatch ? CYCLE_CAUSE::HDBT_MISS : CYCLE_CAUSE::RETIRING;
+    ++sim_stats.opcodeCycles(retire_begin->bytecode_opcode).cycles[champsim::to_underlying(cause)];
+  }
   ROB.erase(retire_begin, retire_end);
 
   return retire_count;
 }
 
+void O3_CPU::account_stall_cycle()
+{
+  auto opcode = fetch_opcode;
+  auto cause = CYCLE_CAUSE::FRONTEND;
+  // An access still waiting after the cache's hit latency has missed, until then it is the normal latency of a hit
+  auto outlived_hit = [cycle = current_cycle](const CACHE* cache, uint64_t issue_cycle) {
+    return cache == nullptr || cycle - issue_cycle > cache->HIT_LATENCY;
+  };
+  if (!std::empty(ROB)) {
+    // The ROB head holds retirement up
+    const auto& head = ROB.front();
+    opcode = head.bytecode_opcode;
+    auto waits_on_miss = [id = head.instr_id, &outlived_hit, l1d = l1d](const std::optional<LSQ_ENTRY>& lq_entry) {
+      return lq_entry.has_value() && lq_entry->instr_id == id && lq_entry->fetch_issued && outlived_hit(l1d, lq_entry->issue_cycle);
+    };
+    if (head.ld_type == load_type::MISS_BPC_PRED)
+      cause = CYCLE_CAUSE::BYTECODE_MISPREDICT;
+    else if (head.hdbt_miss_dispatch)
+      cause = CYCLE_CAUSE::HDBT_MISS;
+    else if (head.completed_mem_ops < head.num_mem_ops() && std::any_of(std::begin(LQ), std::end(LQ), waits_on_miss))
+      cause = CYCLE_CAUSE::L1D_MISS;
+    else
+      cause = CYCLE_CAUSE::BACKEND;
+  } else if (bytecode_buffer_miss) {
+    cause = CYCLE_CAUSE::BB_MISS;
+  } else if (miss_BPC_pred) {
+    cause = CYCLE_CAUSE::BYTECODE_MISPREDICT;
+  } else if (!std::empty(IFETCH_BUFFER)) {
+    const auto& next = IFETCH_BUFFER.front();
+    opcode = next.bytecode_opcode;
+    if (next.hdbt_miss_dispatch)
+      cause = CYCLE_CAUSE::HDBT_MISS;
+    else if (next.fetched == INFLIGHT && outlived_hit(l1i, next.fetch_issue_cycle))
+      cause = CYCLE_CAUSE::L1I_MISS;
+  }
+  ++sim_stats.opcodeCycles(opcode).cycles[champsim::to_underlying(cause)];
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void O3_CPU::print_deadlock()
 {
@@ -1082,7 +1415,7 @@ void O3_CPU::print_deadlock()
   champsim::range_print_deadlock(SQ, "cpu" + std::to_string(cpu) + "_SQ", sq_fmt, sq_pack);
 
   // Print BYTECODE MODULE
-  if constexpr (champsim::skip_dispatch) {
+  if (skips_dispatch()) {
     fmt::print("Status of bytecode module. Fetching: {}, addr: {:x} \n", bytecode_module.bb_buffer.currFetching.first,
                bytecode_module.bb_buffer.currFetching.second);
     fmt::print("Hit in BB: {} \n", bytecode_module.bb_buffer.hitInBB(bytecode_module.bb_buffer.currFetching.second));
@@ -19,6 +19,7 @@
 #include <utility>
 #include <vector>
 
+#include "bytecode_opcodes.h"
 #include "stats_printer.h"
 #include <fmt/core.h>
 #include <fmt/ostream.h>
@@ -38,6 +39,7 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
 
   fmt::print(stream, "\n{} cumulative IPC: {:.4g} instructions: {} cycles: {}\n", stats.name, std::ceil(stats.instrs()) / std::ceil(stats.cycles()),
              stats.instrs(), stats.cycles());
+  fmt::print(stream, "{} dispatch mode: {}\n", stats.name, dispatch_mode_names.at(to_underlying(stats.dispatch)));
   fmt::print(stream, "{} Branch Prediction Accuracy: {:.4g}% MPKI: {:.4g} Average ROB Occupancy at Mispredict: {:.4g}\n", stats.name,
              (100.0 * std::ceil(total_branch - total_mispredictions)) / total_branch, (1000.0 * total_mispredictions) / std::ceil(stats.instrs()),
              std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / total_mispredictions);
@@ -53,7 +55,11 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   fmt::print(stream, "Skipped instrs: {}\n", stats.skipped_instrs);
   fmt::print(stream, "Bytecode jump predicitons, correct: {} wrong {}, not found skip target: {}, stopped early: {} \n", stats.correctBytecodeJumpPredictions, stats.wrongBytecodeJumpPredictions, stats.notFoundSkipTarget, stats.stopppedEarly);
 
-  if constexpr (skip_dispatch) {
+  if (!skips_dispatch(stats.dispatch)) {
+    fmt::print(stream, "Bytecode pre-decode BTB installs: {}, useful: {}, next bytecode not in BB: {}, no handler: {} \n", stats.bb_mod.predecode_installs, stats.bb_mod.predecode_useful, stats.bb_mod.predecode_not_buffered, stats.bb_mod.predecode_no_handler);
+  }
+
+  if (skips_dispatch(stats.dispatch)) {
     auto safe_divide = [](double numerator, double denominator) -> double {
         if (denominator == 0.0) {
             return -1.0;
@@ -85,6 +91,22 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
     fmt::print(stream, "\n");
 
     fmt::print(stream, "BYTECODE BUFFER stats, hits: {} miss: {}, percentage hits: {}, average miss cycles: {}, prefetches: {}, total fetches for misses: {}, total prefetches: {}, inflight misses: {}, duplicated_prefetches: {}, aggressive prefetches: {} \n", stats.bb_stats.hits, stats.bb_stats.miss, safe_divide(static_cast<double>(100 * stats.bb_stats.hits), static_cast<double>(stats.bb_stats.hits + stats.bb_stats.miss)), stats.bb_stats.averageWaitTime(), stats.bb_stats.prefetches, stats.bytecode_fetches[false], stats.bytecode_fetches[true], stats.bb_stats.inflightMisses, stats.bb_stats.duplicated_prefetches, stats.bb_stats.aggressive_prefetches);
+    fmt::print(stream, "BYTECODE BUFFER early restarts: {}, cycles saved: {}, saved per miss: {} \n", stats.bb_stats.early_restarts, stats.bb_stats.early_restart_saved, safe_divide(static_cast<double>(stats.bb_stats.early_restart_saved), static_cast<double>(stats.bb_stats.early_restarts)));
+    auto const& l1 = stats.bb_mod.l1_stats;
+    fmt::print(stream, "BYTECODE L1 stats, hits: {} miss: {}, percentage hits: {}, average fill cycles: {}, merged misses: {}, mshr full: {} \n", l1.hits, l1.miss, safe_divide(static_cast<double>(100 * l1.hits), static_cast<double>(l1.hits + l1.miss)), safe_divide(static_cast<double>(l1.totalFillWait), static_cast<double>(l1.fills)), l1.merged, l1.mshr_full);
+
+    fmt::print(stream, "BYTECODE BUFFER run-ahead prefetches: {}, useful: {}, accuracy: {}, timely: {}, late: {}, timeliness: {} \n", stats.bb_stats.runahead_prefetches, stats.bb_stats.runahead_useful, safe_divide(static_cast<double>(100 * stats.bb_stats.runahead_useful), static_cast<double>(stats.bb_stats.runahead_prefetches)), stats.bb_stats.runahead_timely, stats.bb_stats.runahead_late, safe_divide(static_cast<double>(100 * stats.bb_stats.runahead_timely), static_cast<double>(stats.bb_stats.runahead_useful)));
+
+    fmt::print(stream, "BYTECODE BUFFER dual path fetches: {}, used: {}, accuracy: {} \n", stats.bb_stats.dual_path_fetches, stats.bb_stats.dual_path_used, safe_divide(static_cast<double>(100 * stats.bb_stats.dual_path_used), static_cast<double>(stats.bb_stats.dual_path_fetches)));
+
+    fmt::print(stream, "BYTECODE context switches: {}, retained BB rows: {}, retained HDBT entries: {}, retained DBTB entries: {}, DBTB slot conflicts: {} \n", stats.bb_mod.context_switches, stats.bb_mod.switch_bb_rows, stats.bb_mod.switch_hdbt_entries, stats.bb_mod.switch_dbtb_entries, stats.bb_mod.dbtb_slot_conflicts);
+
+    fmt::print(stream, "BYTECODE BUFFER coherence, quickening writes: {}, invalidations: {}, misses on invalidated rows: {}, stores into rows in flight: {}, rows updated: {} \n", stats.bb_stats.quickening_writes, stats.bb_stats.coherence_invalidations, stats.bb_stats.coherence_misses, stats.bb_stats.coherence_inflight, stats.bb_stats.coherence_updates);
+    fmt::print(stream, "Quickening writes: \n");
+    for (auto const& [opcode, writes] : stats.bb_mod.quickening_writes) {
+      fmt::print(stream, " bytecode: {} times: {} ", getOpcodeName(opcode), writes);
+    }
+    fmt::print(stream, "\n");
 
     fmt::print(stream, "BYTECODE BUFFER ENTRIES:\n");
     for (auto const &entry : stats.bb_stats.entryStats) {
@@ -93,6 +115,8 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
 
     fmt::print(stream, "BYTECODE HDBT stats, hits: {} miss: {}, percentage hits: {} \n", stats.hdbt_stats.hits, stats.hdbt_stats.miss, safe_divide(100 * stats.hdbt_stats.hits, stats.hdbt_stats.hits + stats.hdbt_stats.miss));
 
+    fmt::print(stream, "BYTECODE HDBT handler prefetches: {}, dispatches: {}, covered: {}, coverage: {}, late: {} \n", stats.hdbt_stats.handler_prefetches, stats.hdbt_stats.handler_dispatches, stats.hdbt_stats.covered, safe_divide(static_cast<double>(100 * stats.hdbt_stats.covered), static_cast<double>(stats.hdbt_stats.handler_dispatches)), stats.hdbt_stats.late);
+
     fmt::print(stream, "BYTECODE HDBT ENTRIES:\n");
     for (auto const &entry : stats.hdbt_stats.entryStats) {
           fmt::print(stream, "\t [{}] hits: {}, # switched: {}, # miss: {} \n", entry.opcode, entry.hits, entry.timesSwitchedOut, entry.miss);
@@ -102,7 +126,25 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
     fmt::print(stream, "BYTECODE BTB: \n\t very large jumps: {} \n\t large jumps: {} \n\t small jumps: {} \n", stats.bb_mod.very_large_jumps, stats.bb_mod.large_jumps, stats.bb_mod.small_jumps);
   
     fmt::print(stream, "BYTECODE BTB - strong: {}, weak: {}, wrong: {}, total mispredicts: {}, total lost cycles to mispredict: {} \n", stats.bb_mod.strongly_correct, stats.bb_mod.weakly_correct, stats.bb_mod.wrong, stats.miss_bpc, stats.miss_BPC_pred_penalty);
-    
+    fmt::print(stream, "BYTECODE storage bits, BB: {}, HDBT: {}, target predictor: {}, RAS: {}, fusion: {}, L1: {}, decode: {}, total: {} \n", stats.bb_mod.storage.bb, stats.bb_mod.storage.hdbt, stats.bb_mod.storage.target_predictor, stats.bb_mod.storage.ras, stats.bb_mod.storage.fusion, stats.bb_mod.storage.l1, stats.bb_mod.storage.decode, stats.bb_mod.storage.total());
+    auto const& oparg = stats.bb_mod.dbtb_oparg_stats;
+    fmt::print(stream, "BYTECODE BTB oparg level lookups: {}, hits: {}, allocations: {}, evictions: {}, opcode-only accuracy: {}, accuracy: {}, gain: {} \n", oparg.lookups, oparg.hits, oparg.allocations, oparg.evictions, safe_divide(static_cast<double>(100 * oparg.opcode_only_correct), static_cast<double>(oparg.lookups)), safe_divide(static_cast<double>(100 * oparg.correct), static_cast<double>(oparg.lookups)), safe_divide(100 * (static_cast<double>(oparg.correct) - static_cast<double>(oparg.opcode_only_correct)), static_cast<double>(oparg.lookups)));
+    fmt::print(stream, "BYTECODE TARGET PREDICTOR: {}, storage bits: {}\n", stats.bb_mod.target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE ? "tage" : "dbtb", stats.bb_mod.target_predictor_storage_bits);
+    if (stats.bb_mod.target_predictor == BYTECODE_TARGET_PREDICTOR::TAGE) {
+      fmt::print(stream, "BYTECODE TAGE base predictions: {}, correct: {}, allocations: {}, failed allocations: {} \n", stats.bb_mod.tage_stats.base_predictions, stats.bb_mod.tage_stats.base_correct, stats.bb_mod.tage_stats.allocations, stats.bb_mod.tage_stats.failed_allocations);
+      for (std::size_t i = 0; i < TAGE_NUM_TABLES; i++)
+        fmt::print(stream, "\t [history {}] provider predictions: {}, correct: {} \n", TAGE_HISTORY_LENGTHS[i], stats.bb_mod.tage_stats.provider_predictions[i], stats.bb_mod.tage_stats.provider_correct[i]);
+    }
+
+    fmt::print(stream, "BYTECODE DIRECTION predictions: {}, correct: {}, accuracy: {}, taken: {}, predicted taken: {} \n", stats.bb_mod.direction_stats.predictions, stats.bb_mod.direction_stats.correct, safe_divide(static_cast<double>(100 * stats.bb_mod.direction_stats.correct), static_cast<double>(stats.bb_mod.direction_stats.predictions)), stats.bb_mod.direction_stats.taken, stats.bb_mod.direction_stats.predicted_taken);
+    fmt::print(stream, "BYTECODE LOOP overrides: {}, correct: {}, accuracy: {}, exit overrides: {}, exits correct: {}, exit prefetches: {}, allocations: {} \n", stats.bb_mod.loop_stats.overrides, stats.bb_mod.loop_stats.correct, safe_divide(static_cast<double>(100 * stats.bb_mod.loop_stats.correct), static_cast<double>(stats.bb_mod.loop_stats.overrides)), stats.bb_mod.loop_stats.exit_overrides, stats.bb_mod.loop_stats.exit_correct, stats.bb_mod.loop_stats.exit_prefetches, stats.bb_mod.loop_stats.allocations);
+    fmt::print(stream, "BYTECODE RAS hits: {}, miss: {}, percentage hits: {}, pushes: {}, pops: {}, overflows: {}, underflows: {}, frameless calls: {} \n", stats.bb_mod.ras_stats.hits, stats.bb_mod.ras_stats.miss, safe_divide(static_cast<double>(100 * stats.bb_mod.ras_stats.hits), static_cast<double>(stats.bb_mod.ras_stats.hits + stats.bb_mod.ras_stats.miss)), stats.bb_mod.ras_stats.pushes, stats.bb_mod.ras_stats.pops, stats.bb_mod.ras_stats.overflows, stats.bb_mod.ras_stats.underflows, stats.bb_mod.ras_stats.frameless_calls);
+
+    fmt::print(stream, "BYTECODE FUSION fused dispatches: {}, instructions saved: {}, cycles saved: {}, observed pairs: {}, allocations: {} \n", stats.bb_mod.fusion_stats.fused, stats.bb_mod.fusion_stats.instructions_saved, stats.bb_mod.fusion_stats.cycles_saved, stats.bb_mod.fusion_stats.observed_pairs, stats.bb_mod.fusion_stats.allocations);
+    for (auto const &pair : stats.bb_mod.fusion_stats.pairStats) {
+          fmt::print(stream, "\t [{} + {}] fused: {}, instructions saved: {}, cycles saved: {} \n", getOpcodeName(pair.first), getOpcodeName(pair.second), pair.fused, pair.instructions_saved, pair.cycles_saved);
+    }
+
     fmt::print(stream, "BYTECODE BTB ENTRIES:\n");
     for (auto const &[opcode, entry_stats] : stats.bb_mod.dbtb_entryStats) {
           fmt::print(stream, "\t [{}] hits: {}, # miss: {} \n", opcode, entry_stats.hit, entry_stats.miss);
@@ -138,6 +180,17 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
     fmt::print("\n");
   }
 
+  fmt::print(stream, "{} cycles by opcode, retiring and stalls at the ROB head or in fetch:\n", stats.name);
+  fmt::print(stream, "{:<32} {:>10} {:>12} {:>12}", "opcode", "bytecodes", "instrs", "cycles");
+  for (auto cause : cycle_cause_names)
+    fmt::print(stream, " {:>20}", cause);
+  fmt::print(stream, "\n");
+  for (auto const& [opcode, cycles] : stats.opcodeCyclesByTotal()) {
+    fmt::print(stream, "{:<32} {:>10} {:>12} {:>12}", opcode < 0 ? "(before first bytecode)" : getOpcodeName(opcode), cycles.bytecodes, cycles.instrs, cycles.total());
+    for (auto cause_cycles : cycles.cycles)
+      fmt::print(stream, " {:>20}", cause_cycles);
+    fmt::print(stream, "\n");
+  }
 }
 
 void champsim::plain_printer::print(CACHE::stats_type stats)
@@ -278,185 +331,7 @@ bool haveSameKeys(const std::map<K, V>& map1, const std::map<K, V>& map2) {
 }
 
 std::string champsim::plain_printer::getOpcodeName(int opcode) {
-    switch(opcode) {
-        case 0: return "CACHE";
-        case 1: return "POP_TOP";
-        case 2: return "PUSH_NULL";
-        case 3: return "BINARY_OP_ADAPTIVE";
-        case 4: return "BINARY_OP_ADD_FLOAT";
-        case 5: return "BINARY_OP_ADD_INT";
-        case 6: return "BINARY_OP_ADD_UNICODE";
-        case 7: return "BINARY_OP_INPLACE_ADD_UNICODE";
-        case 8: return "BINARY_OP_MULTIPLY_FLOAT";
-        case 9: return "NOP";
-        case 10: return "UNARY_POSITIVE";
-        case 11: return "UNARY_NEGATIVE";
-        case 12: return "UNARY_NOT";
-        case 13: return "BINARY_OP_MULTIPLY_INT";
-        case 14: return "BINARY_OP_SUBTRACT_FLOAT";
-        case 15: return "UNARY_INVERT";
-        case 16: return "BINARY_OP_SUBTRACT_INT";
-        case 17: return "BINARY_SUBSCR_ADAPTIVE";
-        case 18: return "BINARY_SUBSCR_DICT";
-        case 19: return "BINARY_SUBSCR_GETITEM";
-        case 20: return "BINARY_SUBSCR_LIST_INT";
-        case 21: return "BINARY_SUBSCR_TUPLE_INT";
-        case 22: return "CALL_ADAPTIVE";
-        case 23: return "CALL_PY_EXACT_ARGS";
-        case 24: return "CALL_PY_WITH_DEFAULTS";
-        case 25: return "BINARY_SUBSCR";
-        case 26: return "COMPARE_OP_ADAPTIVE";
-        case 27: return "COMPARE_OP_FLOAT_JUMP";
-        case 28: return "COMPARE_OP_INT_JUMP";
-        case 29: return "COMPARE_OP_STR_JUMP";
-        case 30: return "GET_LEN";
-        case 31: return "MATCH_MAPPING";
-        case 32: return "MATCH_SEQUENCE";
-        case 33: return "MATCH_KEYS";
-        case 34: return "EXTENDED_ARG_QUICK";
-        case 35: return "PUSH_EXC_INFO";
-        case 36: return "CHECK_EXC_MATCH";
-        case 37: return "CHECK_EG_MATCH";
-        case 38: return "JUMP_BACKWARD_QUICK";
-        case 39: return "LOAD_ATTR_ADAPTIVE";
-        case 40: return "LOAD_ATTR_INSTANCE_VALUE";
-        case 41: return "LOAD_ATTR_MODULE";
-        case 42: return "LOAD_ATTR_SLOT";
-        case 43: return "LOAD_ATTR_WITH_HINT";
-        case 44: return "LOAD_CONST__LOAD_FAST";
-        case 45: return "LOAD_FAST__LOAD_CONST";
-        case 46: return "LOAD_FAST__LOAD_FAST";
-        case 47: return "LOAD_GLOBAL_ADAPTIVE";
-        case 48: return "LOAD_GLOBAL_BUILTIN";
-        case 49: return "WITH_EXCEPT_START";
-        case 50: return "GET_AITER";
-        case 51: return "GET_ANEXT";
-        case 52: return "BEFORE_ASYNC_WITH";
-        case 53: return "BEFORE_WITH";
-        case 54: return "END_ASYNC_FOR";
-        case 55: return "LOAD_GLOBAL_MODULE";
-        case 56: return "LOAD_METHOD_ADAPTIVE";
-        case 57: return "LOAD_METHOD_CLASS";
-        case 58: return "LOAD_METHOD_MODULE";
-        case 59: return "LOAD_METHOD_NO_DICT";
-        case 60: return "STORE_SUBSCR";
-        case 61: return "DELETE_SUBSCR";
-        case 62: return "LOAD_METHOD_WITH_DICT";
-        case 63: return "LOAD_METHOD_WITH_VALUES";
-        case 64: return "PRECALL_ADAPTIVE";
-        case 65: return "PRECALL_BOUND_METHOD";
-        case 66: return "PRECALL_BUILTIN_CLASS";
-        case 67: return "PRECALL_BUILTIN_FAST_WITH_KEYWORDS";
-        case 68: return "GET_ITER";
-        case 69: return "GET_YIELD_FROM_ITER";
-        case 70: return "PRINT_EXPR";
-        case 71: return "LOAD_BUILD_CLASS";
-        case 72: return "PRECALL_METHOD_DESCRIPTOR_FAST_WITH_KEYWORDS";
-        case 73: return "PRECALL_NO_KW_BUILTIN_FAST";
-        case 74: return "LOAD_ASSERTION_ERROR";
-        case 75: return "RETURN_GENERATOR";
-        case 76: return "PRECALL_NO_KW_BUILTIN_O";
-        case 77: return "PRECALL_NO_KW_ISINSTANCE";
-        case 78: return "PRECALL_NO_KW_LEN";
-        case 79: return "PRECALL_NO_KW_LIST_APPEND";
-        case 80: return "PRECALL_NO_KW_METHOD_DESCRIPTOR_FAST";
-        case 81: return "PRECALL_NO_KW_METHOD_DESCRIPTOR_NOARGS";
-        case 82: return "LIST_TO_TUPLE";
-        case 83: return "RETURN_VALUE";
-        case 84: return "IMPORT_STAR";
-        case 85: return "SETUP_ANNOTATIONS";
-        case 86: return "YIELD_VALUE";
-        case 87: return "ASYNC_GEN_WRAP";
-        case 88: return "PREP_RERAISE_STAR";
-        case 89: return "POP_EXCEPT";
-        case 90: return "HAVE_ARGUMENT";
-        case 91: return "DELETE_NAME";
-        case 92: return "UNPACK_SEQUENCE";
-        case 93: return "FOR_ITER";
-        case 94: return "UNPACK_EX";
-        case 95: return "STORE_ATTR";
-        case 96: return "DELETE_ATTR";
-        case 97: return "STORE_GLOBAL";
-        case 98: return "DELETE_GLOBAL";
-        case 99: return "SWAP";
-        case 100: return "LOAD_CONST";
-        case 101: return "LOAD_NAME";
-        case 102: return "BUILD_TUPLE";
-        case 103: return "BUILD_LIST";
-        case 104: return "BUILD_SET";
-        case 105: return "BUILD_MAP";
-        case 106: return "LOAD_ATTR";
-        case 107: return "COMPARE_OP";
-        case 108: return "IMPORT_NAME";
-        case 109: return "IMPORT_FROM";
-        case 110: return "JUMP_FORWARD";
-        case 111: return "JUMP_IF_FALSE_OR_POP";
-        case 112: return "JUMP_IF_TRUE_OR_POP";
-        case 113: return "PRECALL_NO_KW_METHOD_DESCRIPTOR_O";
-        case 114: return "POP_JUMP_FORWARD_IF_FALSE";
-        case 115: return "POP_JUMP_FORWARD_IF_TRUE";
-        case 116: return "LOAD_GLOBAL";
-        case 117: return "IS_OP";
-        case 118: return "CONTAINS_OP";
-        case 119: return "RERAISE";
-        case 120: return "COPY";
-        case 121: return "PRECALL_NO_KW_STR_1";
-        case 122: return "BINARY_OP";
-        case 123: return "SEND";
-        case 124: return "LOAD_FAST";
-        case 125: return "STORE_FAST";
-        case 126: return "DELETE_FAST";
-        case 127: return "POP_JUMP_FORWARD_IF_NOT_NONE";
-        case 128: return "POP_JUMP_FORWARD_IF_NONE";
-        case 129: return "RAISE_VARARGS";
-        case 130: return "GET_AWAITABLE";
-        case 131: return "MAKE_FUNCTION";
-        case 132: return "BUILD_SLICE";
-        case 133: return "JUMP_BACKWARD_NO_INTERRUPT";
-        case 134: return "MAKE_CELL";
-        case 135: return "LOAD_CLOSURE";
-        case 136: return "LOAD_DEREF";
-        case 137: return "STORE_DEREF";
-        case 138: return "DELETE_DEREF";
-        case 139: return "JUMP_BACKWARD";
-        case 140: return "CALL_FUNCTION_EX";
-        case 141: return "EXTENDED_ARG";
-        case 142: return "LIST_APPEND";
-        case 143: return "SET_ADD";
-        case 144: return "MAP_ADD";
-        case 145: return "LOAD_CLASSDEREF";
-        case 146: return "COPY_FREE_VARS";
-        case 147: return "RESUME";
-        case 148: return "MATCH_CLASS";
-        case 149: return "FORMAT_VALUE";
-        case 150: return "BUILD_CONST_KEY_MAP";
-        case 151: return "BUILD_STRING";
-        case 152: return "LOAD_METHOD";
-        case 153: return "LIST_EXTEND";
-        case 154: return "SET_UPDATE";
-        case 155: return "DICT_MERGE";
-        case 156: return "DICT_UPDATE";
-        case 157: return "PRECALL";
-        case 158: return "CALL";
-        case 159: return "KW_NAMES";
-        case 160: return "POP_JUMP_BACKWARD_IF_NOT_NONE";
-        case 161: return "POP_JUMP_BACKWARD_IF_NONE";
-        case 162: return "POP_JUMP_BACKWARD_IF_FALSE";
-        case 163: return "POP_JUMP_BACKWARD_IF_TRUE";
-        case 164: return "STORE_ATTR_ADAPTIVE";
-        case 165: return "STORE_ATTR_INSTANCE_VALUE";
-        case 166: return "STORE_ATTR_SLOT";
-        case 167: return "STORE_ATTR_WITH_HINT";
-        case 168: return "STORE_FAST__LOAD_FAST";
-        case 169: return "STORE_FAST__STORE_FAST";
-        case 170: return "STORE_SUBSCR_ADAPTIVE";
-        case 171: return "STORE_SUBSCR_DICT";
-        case 172: return "STORE_SUBSCR_LIST_INT";
-        case 173: return "UNPACK_SEQUENCE_ADAPTIVE";
-        case 174: return "UNPACK_SEQUENCE_LIST";
-        case 175: return "UNPACK_SEQUENCE_TUPLE";
-        case 176: return "UNPACK_SEQUENCE_TWO_TUPLE";
-        case 177: return "DO_TRACING";
-        default: return "UNKNOWN OPCODE";
-    }
+    if (opcode < 0 || static_cast<std::size_t>(opcode) >= std::size(bytecode_opcode::names) || bytecode_opcode::names[static_cast<std::size_t>(opcode)].empty())
+        return "UNKNOWN OPCODE";
+    return std::string{bytecode_opcode::names[static_cast<std::size_t>(opcode)]};
 }
\ No newline at end of file
@@ -32,6 +32,59 @@ ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_inst
   return branch;
 }
 
+multiplexed_tracereader::multiplexed_tracereader(std::vector<tracereader>&& traces, uint64_t quantum_instrs)
+    : threads(std::move(traces)), held(std::size(threads)), quantum(quantum_instrs)
+{
+}
+
+void multiplexed_tracereader::next_thread()
+{
+  executed = 0;
+  for (std::size_t i = 1; i <= std::size(threads); ++i) {
+    auto candidate = (current + i) % std::size(threads);
+    if (!exhausted(candidate)) {
+      current = candidate;
+      return;
+    }
+  }
+}
+
+ooo_model_instr multiplexed_tracereader::take()
+{
+  if (held.at(current).has_value()) {
+    auto instr = *held.at(current);
+    held.at(current).reset();
+    return instr;
+  }
+  return threads.at(current)();
+}
+
+ooo_model_instr multiplexed_tracereader::operator()()
+{
+  if (exhausted(current))
+    next_thread();
+
+  auto instr = take();
+  if (std::size(threads) > 1 && executed >= quantum && (instr.ld_type == load_type::BLW || executed >= 2 * quantum)) {
+    held.at(current) = instr;
+    next_thread();
+    instr = take();
+  }
+
+  executed++;
+  instr.asid = {static_cast<uint8_t>(current), static_cast<uint8_t>(current)};
+  return instr;
+}
+
+bool multiplexed_tracereader::eof() const
+{
+  for (std::size_t thread = 0; thread < std::size(threads); ++thread) {
+    if (!exhausted(thread))
+      return false;
+  }
+  return true;
+}
+
 template <template <class, class> typename R, typename T>
 champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu)
 {
@@ -0,0 +1,316 @@
+/*
+ * Bytecode-only functional simulator for BB, HDBT and DBTB design sweeps.
+ *
+ * Streams a bytecode trace once and drives only the bytecode events through
+ * shadow instances of every configuration under study, instead of running a
+ * full timing simulation per design point. A BLW load starts a bytecode and
+ * the BTG load that follows it marks the dispatch as one the core skips,
+ * which is when the timing model consults the bytecode structures.
+ *
+ * BB fills for demand misses complete before the bytecode continues,
+ * prefetched rows arrive --fill-latency bytecodes after they were requested.
+ * The BB and DBTB are swept together, as the BB prefetches along the DBTB
+ * prediction; the HDBT only sees opcodes and is swept on its own.
+ *
+ * Given a --budget-kb, the sweep also sizes the structures for that storage
+ * budget: of the BB, DBTB and HDBT combinations that leave the indirect BTB
+ * room for at least --min-indirect-entries, it picks the one whose bytecodes
+ * most often hit in all three. A combination is charged for every structure
+ * BYTECODE_MODULE::storage() charges the indirect BTB for in the timing
+ * model, so the RAS and what else the module holds count against the budget
+ * too.
+ *
+ * Build with `make sweep`.
+ */
+
+#include <deque>
+#include <limits>
+#include <string>
+#include <vector>
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+#include "bytecode_module.h"
+#include "tracereader.h"
+
+namespace
+{
+constexpr uint64_t DEFAULT_FILL_LATENCY = 4;
+constexpr std::size_t DEFAULT_MIN_INDIRECT_ENTRIES = 1024;
+constexpr uint64_t INDIRECT_ENTRY_BITS = 64; // A target, as in the basic BTB's indirect table
+
+struct bb_point {
+  std::size_t rows;
+  uint64_t row_size;
+  std::size_t dbtb_entries;
+  BYTECODE_MODULE module;
+  std::deque<std::pair<uint64_t, uint64_t>> fills = {}; // (ready at bytecode, address)
+  bool predicted = false;
+};
+
+struct hdbt_point {
+  std::size_t sets;
+  std::size_t ways;
+  BYTECODE_HDBT hdbt;
+};
+
+// "AxB" into {A, B}
+std::pair<std::size_t, std::size_t> parse_pair(const std::string& text)
+{
+  auto split = text.find('x');
+  if (split == std::string::npos) {
+    fmt::print(stderr, "Expected a value of the form AxB, got {}\n", text);
+    exit(1);
+  }
+  return {std::stoull(text.substr(0, split)), std::stoull(text.substr(split + 1))};
+}
+
+double hit_fraction(uint64_t hits, uint64_t misses) { return (hits + misses) == 0 ? 1.0 : static_cast<double>(hits) / static_cast<double>(hits + misses); }
+
+// Fraction of dispatches where the BB has the bytecode and the DBTB its successor, assuming independence from the HDBT
+double bb_score(const bb_point& point)
+{
+  auto const& bb_stats = point.module.bb_buffer.stats;
+  auto const& mod_stats = point.module.stats;
+  return hit_fraction(bb_stats.hits, bb_stats.miss)
+         * hit_fraction(mod_stats.strongly_correct + mod_stats.weakly_correct, mod_stats.wrong);
+}
+
+// What the timing model charges the indirect BTB for the point's structures with the swept HDBT in place of its own
+BYTECODE_STORAGE point_storage(const bb_point& point, const hdbt_point& hdbt)
+{
+  auto storage = point.module.storage();
+  storage.hdbt = hdbt.hdbt.storageBits();
+  return storage;
+}
+
+void complete_fill(BYTECODE_BUFFER& bb, uint64_t addr, uint64_t now)
+{
+  if (bb.blockIsNeeded(addr))
+    bb.updateBufferEntries(addr, now);
+}
+
+void dispatch(bb_point& point, uint64_t now, uint64_t fill_latency, uint64_t bpc, int opcode, int oparg)
+{
+  auto& module = point.module;
+  auto& bb = module.bb_buffer;
+
+  while (!std::empty(point.fills) && point.fills.front().first <= now) {
+    complete_fill(bb, point.fills.front().second, now);
+    point.fills.pop_front();
+  }
+
+  if (!bb.hitInBB(bpc)) {
+    // The bytecode waits for its row, and for any prefetch of it that is already in flight
+    if (bb.shouldFetch(bpc))
+      bb.fetching(bpc, now, false);
+    complete_fill(bb, bpc, now);
+  }
+
+  if (point.predicted)
+    module.correctPrediction(bpc);
+  auto next_bpc = module.predict_branching(opcode, oparg, bpc);
+  point.predicted = true;
+  if (bb.shouldFetch(next_bpc)) {
+    bb.fetching(next_bpc, now, true);
+    point.fills.emplace_back(now + fill_latency, next_bpc);
+  }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Bytecode-only functional simulator for BB, HDBT and DBTB design sweeps"};
+
+  std::vector<std::string> bb_configs{"1x8", "2x8", "4x8", "6x8", "8x8", "1x16", "2x16", "3x16", "4x16"};
+  std::vector<std::string> hdbt_configs{"2x4", "4x4", "8x4", "16x4", "32x4", "64x4"};
+  std::vector<std::size_t> dbtb_configs{0, 8, 16, 32, 64, 128, 256};
+  bool sectored{false};
+  std::string predictor{"dbtb"};
+  uint64_t fill_latency = DEFAULT_FILL_LATENCY;
+  uint64_t warmup_instructions = 0;
+  uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
+  double budget_kb = 0;
+  std::size_t min_indirect_entries = DEFAULT_MIN_INDIRECT_ENTRIES;
+  std::string trace_name;
+
+  app.add_option("--bb", bb_configs, "BB geometries to sweep, as ROWSxROW_SIZE")->capture_default_str();
+  app.add_option("--hdbt", hdbt_configs, "HDBT geometries to sweep, as SETSxWAYS")->capture_default_str();
+  app.add_option("--dbtb", dbtb_configs, "DBTB sizes to sweep, in entries")->capture_default_str();
+  app.add_flag("--sectored", sectored, "Use sectored BB rows");
+  app.add_option("--predictor", predictor, "Bytecode target predictor, dbtb or tage")->capture_default_str()->check(CLI::IsMember({"dbtb", "tage"}));
+  app.add_option("--fill-latency", fill_latency, "Bytecodes between a BB prefetch and its fill")->capture_default_str();
+  app.add_option("--budget-kb", budget_kb, "Storage budget in KB shared by the bytecode structures and the indirect BTB, 0 skips the sizing");
+  app.add_option("--min-indirect-entries", min_indirect_entries, "Indirect BTB entries the sizing leaves at least")->capture_default_str();
+  app.add_option("-w,--warmup-instructions", warmup_instructions, "The number of instructions before the statistics are reset");
+  app.add_option("-i,--simulation-instructions", simulation_instructions, "The number of instructions measured after the warmup");
+  app.add_option("trace", trace_name, "The path to the bytecode trace")->required()->check(CLI::ExistingFile);
+
+  CLI11_PARSE(app, argc, argv);
+
+  auto target_predictor = (predictor == "tage") ? BYTECODE_TARGET_PREDICTOR::TAGE : BYTECODE_TARGET_PREDICTOR::DBTB;
+
+  std::vector<bb_point> bb_points;
+  for (const auto& config : bb_configs) {
+    auto [rows, row_size] = parse_pair(config);
+    for (auto entries : dbtb_configs) {
+      bb_points.push_back(bb_point{rows, row_size, entries,
+                                   BYTECODE_MODULE{BYTECODE_BUFFER{rows, row_size, 0, BB_RUNAHEAD_CONFIDENCE, 0, sectored, BB_COHERENCE::NONE, 0, false}, BYTECODE_HDBT{},
+                                                   BYTECODE_BTB{entries}, target_predictor, BYTECODE_RAS{}, BYTECODE_FUSION{},
+                                                   BYTECODE_DIRECTION{}, BYTECODE_LOOP{}, BYTECODE_L1{},
+                                                   BYTECODE_CONTEXT_SWITCH::NONE}});
+    }
+  }
+  for (auto& point : bb_points)
+    point.module.initialize(0);
+
+  std::vector<hdbt_point> hdbt_points;
+  for (const auto& config : hdbt_configs) {
+    auto [sets, ways] = parse_pair(config);
+    hdbt_points.push_back(hdbt_point{sets, ways, BYTECODE_HDBT{sets, ways, HDBT_REPLACEMENT::LRU, 0}});
+  }
+
+  auto reader = get_tracereader(trace_name, 0, false, true, false);
+
+  // A bytecode is held until the next BLW, so that a BTG between them marks its dispatch as skipped
+  struct {
+    bool valid = false;
+    bool skipped = false;
+    uint64_t bpc = 0;
+    int opcode = 0;
+    int oparg = 0;
+  } pending;
+
+  uint64_t instructions = 0, bytecodes = 0, dispatches = 0;
+  uint64_t clock = 0; // Bytecodes since the start of the trace, fill times are measured in it
+  bool warm = (warmup_instructions == 0);
+  auto retire_pending = [&]() {
+    if (!pending.valid)
+      return;
+    bytecodes++;
+    clock++;
+    if (pending.skipped) {
+      dispatches++;
+      for (auto& point : bb_points)
+        dispatch(point, clock, fill_latency, pending.bpc, pending.opcode, pending.oparg);
+      for (auto& point : hdbt_points)
+        point.hdbt.hit(pending.opcode);
+    }
+    pending.valid = false;
+  };
+
+  while (!reader.eof() && instructions < warmup_instructions + simulation_instructions) {
+    auto instr = reader();
+    instructions++;
+
+    if (instr.ld_type == load_type::BLW) {
+      retire_pending();
+      pending.valid = true;
+      pending.skipped = false;
+      pending.bpc = instr.source_memory.front();
+      pending.opcode = static_cast<int>(instr.load_val & 0xFF);
+      pending.oparg = (instr.load_size != 8) ? static_cast<int>(instr.load_val >> 8) : 0;
+    } else if (instr.ld_type == load_type::BTG && pending.valid) {
+      pending.skipped = true;
+    }
+
+    if (!warm && instructions >= warmup_instructions) {
+      retire_pending();
+      for (auto& point : bb_points)
+        point.module.resetStats();
+      for (auto& point : hdbt_points)
+        point.hdbt.resetStats();
+      bytecodes = 0;
+      dispatches = 0;
+      warm = true;
+    }
+  }
+  retire_pending();
+
+  fmt::print("\n*** Bytecode design sweep ***\nTrace: {}\nInstructions: {} Bytecodes: {} Skipped dispatches: {}\n\n", trace_name, instructions, bytecodes,
+             dispatches);
+
+  auto safe_divide = [](double numerator, double denominator) -> double {
+    if (denominator == 0.0) {
+      return -1.0;
+    }
+    return numerator / denominator;
+  };
+
+  fmt::print("BB hit rate (%), rows x row size by DBTB entries\n{:>10}", "");
+  for (auto entries : dbtb_configs)
+    fmt::print(" {:>8}", entries);
+  fmt::print("\n");
+  for (std::size_t i = 0; i < std::size(bb_points); i += std::size(dbtb_configs)) {
+    fmt::print("{:>10}", fmt::format("{}x{}", bb_points[i].rows, bb_points[i].row_size));
+    for (std::size_t j = 0; j < std::size(dbtb_configs); j++) {
+      auto const& stats = bb_points[i + j].module.bb_buffer.stats;
+      fmt::print(" {:>8.2f}", safe_divide(static_cast<double>(100 * stats.hits), static_cast<double>(stats.hits + stats.miss)));
+    }
+    fmt::print("\n");
+  }
+
+  fmt::print("\nHDBT hit rate (%)\n");
+  for (auto const& point : hdbt_points) {
+    fmt::print("{:>10} {:>8.2f}\n", fmt::format("{}x{}", point.sets, point.ways),
+               safe_divide(static_cast<double>(100 * point.hdbt.stats.hits), static_cast<double>(point.hdbt.stats.hits + point.hdbt.stats.miss)));
+  }
+
+  fmt::print("\n");
+  for (auto& point : bb_points) {
+    point.module.generateStats();
+    auto const& bb_stats = point.module.bb_buffer.stats;
+    auto const& mod_stats = point.module.stats;
+    fmt::print("BB {}x{} DBTB {}\n", point.rows, point.row_size, point.dbtb_entries);
+    fmt::print("BYTECODE BUFFER stats, hits: {} miss: {}, percentage hits: {}, prefetches: {}, duplicated_prefetches: {}, aggressive prefetches: {} \n",
+               bb_stats.hits, bb_stats.miss, safe_divide(static_cast<double>(100 * bb_stats.hits), static_cast<double>(bb_stats.hits + bb_stats.miss)),
+               bb_stats.prefetches, bb_stats.duplicated_prefetches, bb_stats.aggressive_prefetches);
+    fmt::print("BYTECODE BTB - strong: {}, weak: {}, wrong: {} \n", mod_stats.strongly_correct, mod_stats.weakly_correct, mod_stats.wrong);
+    fmt::print("BYTECODE TARGET PREDICTOR: {}, storage bits: {}\n", predictor, mod_stats.target_predictor_storage_bits);
+    fmt::print("BYTECODE BUFFER storage bits: {}\n", mod_stats.storage.bb);
+  }
+  for (auto const& point : hdbt_points) {
+    fmt::print("HDBT {}x{}\n", point.sets, point.ways);
+    fmt::print("BYTECODE HDBT stats, hits: {} miss: {}, percentage hits: {}, storage bits: {} \n", point.hdbt.stats.hits, point.hdbt.stats.miss,
+               safe_divide(static_cast<double>(100 * point.hdbt.stats.hits), static_cast<double>(point.hdbt.stats.hits + point.hdbt.stats.miss)),
+               point.hdbt.storageBits());
+  }
+
+  if (budget_kb <= 0)
+    return 0;
+
+  auto budget_bits = static_cast<uint64_t>(budget_kb * 8192);
+  bb_point* best_bb = nullptr;
+  const hdbt_point* best_hdbt = nullptr;
+  double best_score = -1;
+  BYTECODE_STORAGE best_storage;
+  for (auto& point : bb_points) {
+    for (auto const& hdbt : hdbt_points) {
+      auto storage = point_storage(point, hdbt);
+      if (storage.total() + min_indirect_entries * INDIRECT_ENTRY_BITS > budget_bits)
+        continue;
+      // Ties go to the smaller split, which leaves more to the indirect BTB
+      auto score = bb_score(point) * hit_fraction(hdbt.hdbt.stats.hits, hdbt.hdbt.stats.miss);
+      if (score > best_score || (score == best_score && storage.total() < best_storage.total())) {
+        best_bb = &point;
+        best_hdbt = &hdbt;
+        best_score = score;
+        best_storage = storage;
+      }
+    }
+  }
+
+  fmt::print("\nIso-storage sizing for {} KB ({} bits), at least {} indirect BTB entries\n", budget_kb, budget_bits, min_indirect_entries);
+  if (best_bb == nullptr) {
+    fmt::print("No swept configuration fits the budget\n");
+    return 0;
+  }
+  fmt::print("BB {}x{}: {} bits\n", best_bb->rows, best_bb->row_size, best_storage.bb);
+  fmt::print("DBTB {}: {} bits\n", best_bb->dbtb_entries, best_storage.target_predictor);
+  fmt::print("HDBT {}x{}: {} bits\n", best_hdbt->sets, best_hdbt->ways, best_storage.hdbt);
+  fmt::print("RAS: {} bits, fusion: {} bits, L1: {} bits, decode: {} bits\n", best_storage.ras, best_storage.fusion, best_storage.l1, best_storage.decode);
+  fmt::print("Bytecode structures: {} bits, given up by the indirect BTB\n", best_storage.total());
+  fmt::print("Dispatches hitting the BB, DBTB and HDBT: {:.2f}%\n", 100 * best_score);
+  fmt::print("\"bytecode_buffer\": {{\"rows\": {}, \"row_size\": {}}}, \"bytecode_hdbt\": {{\"sets\": {}, \"ways\": {}}}, \"bytecode_btb\": {{\"entries\": {}}}\n",
+             best_bb->rows, best_bb->row_size, best_hdbt->sets, best_hdbt->ways, best_bb->dbtb_entries);
+}
@@ -0,0 +1,146 @@
+/*
+ * Microbenchmark for the HDBT lookup path.
+ *
+ * Replays a synthetic opcode stream through BYTECODE_HDBT::hit() for a set of
+ * table sizes and reports the cost per dispatched bytecode. The stream is
+ * skewed towards a small number of hot opcodes, like the traces we run, and
+ * draws from at most 64 distinct opcodes so that every size hits on every
+ * lookup once warmed up. What is left to differ between sizes is the lookup
+ * itself.
+ *
+ * The fully associative vector the HDBT used to be, which ages every entry on
+ * every access, runs alongside for comparison. Costs are also given in cycles
+ * of a dependent add chain, since the wall clock of the machines we run on
+ * varies a lot.
+ *
+ * Build and run with `make bench`.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <fmt/core.h>
+
+#include "bytecode_hdbt.h"
+
+namespace
+{
+constexpr std::size_t STREAM_LENGTH = 1 << 20;
+constexpr std::size_t REPETITIONS = 16;
+constexpr std::size_t WAYS = 4;
+constexpr uint64_t DISTINCT_OPCODES = 64; // Fits the smallest table, so no size misses after warm-up
+
+// The HDBT before it was made set-associative: a linear search that ages every valid entry on each access
+class vector_hdbt
+{
+  struct entry {
+    int opcode;
+    bool valid = true;
+    int lru = STARTING_LRU;
+  };
+  constexpr static int STARTING_LRU = 1 << 12;
+
+  std::vector<entry> table;
+  std::size_t capacity;
+
+  void decrement_lrus()
+  {
+    for (auto& e : table) {
+      if (e.valid && e.lru > 0)
+        e.lru--;
+    }
+  }
+
+public:
+  explicit vector_hdbt(std::size_t capacity_) : capacity(capacity_) {}
+
+  bool hit(int opcode)
+  {
+    auto found = std::find_if(std::begin(table), std::end(table), [opcode](const entry& e) { return e.opcode == opcode; });
+    if (found != std::end(table) && found->valid) {
+      decrement_lrus();
+      found->lru = STARTING_LRU;
+      return true;
+    }
+
+    auto valid = std::count_if(std::begin(table), std::end(table), [](const entry& e) { return e.valid; });
+    if (static_cast<std::size_t>(valid) >= capacity) {
+      auto victim = std::min_element(std::begin(table), std::end(table), [](const entry& a, const entry& b) { return a.valid && (!b.valid || a.lru < b.lru); });
+      victim->valid = false;
+    }
+    decrement_lrus();
+    if (found == std::end(table)) {
+      table.push_back({opcode});
+    } else {
+      found->valid = true;
+      found->lru = STARTING_LRU;
+    }
+    return false;
+  }
+};
+
+std::vector<int> make_opcode_stream()
+{
+  std::vector<int> stream;
+  stream.reserve(STREAM_LENGTH);
+  uint64_t state = 0x9E3779B97F4A7C15;
+  for (std::size_t i = 0; i < STREAM_LENGTH; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    // Three draws, keep the smallest: most dispatches go to the low opcodes
+    auto a = state & 0xFF, b = (state >> 8) & 0xFF, c = (state >> 16) & 0xFF;
+    stream.push_back(static_cast<int>(std::min(a, std::min(b, c)) % DISTINCT_OPCODES));
+  }
+  return stream;
+}
+
+// Nanoseconds per cycle, from a chain of dependent adds that retires one per cycle
+double ns_per_cycle()
+{
+  constexpr uint64_t CHAIN_LENGTH = 1 << 26;
+  uint64_t value = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < CHAIN_LENGTH; i++)
+    asm volatile("add $1, %0" : "+r"(value));
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / static_cast<double>(CHAIN_LENGTH);
+}
+
+template <typename T>
+void run(const char* name, T& hdbt, std::size_t entries, std::size_t sets, const std::vector<int>& stream)
+{
+  uint64_t hits = 0;
+  for (auto opcode : stream)
+    hdbt.hit(opcode); // warm-up, not timed
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t rep = 0; rep < REPETITIONS; rep++) {
+    for (auto opcode : stream) {
+      hits += hdbt.hit(opcode);
+    }
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  // Calibrated next to each run, the clock can change between runs
+  auto cycle_ns = ns_per_cycle();
+  auto lookups = static_cast<double>(STREAM_LENGTH * REPETITIONS);
+  fmt::print("{:>8} {:>8} {:>6} {:>12.2f} {:>15.1f} {:>10.4f}\n", name, entries, sets, elapsed / lookups, elapsed / lookups / cycle_ns,
+             static_cast<double>(hits) / lookups);
+}
+} // namespace
+
+int main()
+{
+  auto stream = make_opcode_stream();
+
+  fmt::print("{:>8} {:>8} {:>6} {:>12} {:>15} {:>10}\n", "table", "entries", "sets", "ns/bytecode", "cycles/bytecode", "hit rate");
+  for (std::size_t entries : {64, 256, 1024}) {
+    BYTECODE_HDBT hdbt{entries / WAYS, WAYS, HDBT_REPLACEMENT::LRU, 0};
+    run("assoc", hdbt, entries, entries / WAYS, stream);
+
+    vector_hdbt old_hdbt{entries};
+    run("vector", old_hdbt, entries, 1, stream);
+  }
+}
@@ -69,6 +69,22 @@ TEMPLATE_TEST_CASE("A fixed-width counter can subtract in place", "", champsim::
   REQUIRE(lhs.value() == 0);
 }
 
+TEMPLATE_TEST_CASE("A fixed-width counter can increment", "", champsim::msl::fwcounter<8>, champsim::msl::sfwcounter<8>) {
+  TestType lhs{1};
+  lhs++;
+  REQUIRE(lhs.value() == 2);
+  ++lhs;
+  REQUIRE(lhs.value() == 3);
+}
+
+TEMPLATE_TEST_CASE("A fixed-width counter can decrement", "", champsim::msl::fwcounter<8>, champsim::msl::sfwcounter<8>) {
+  TestType lhs{2};
+  lhs--;
+  REQUIRE(lhs.value() == 1);
+  --lhs;
+  REQUIRE(lhs.value() == 0);
+}
+
 TEMPLATE_TEST_CASE("A fixed-width counter can multiply", "", champsim::msl::fwcounter<8>, champsim::msl::sfwcounter<8>) {
   TestType lhs{2};
   auto result = lhs * 2;
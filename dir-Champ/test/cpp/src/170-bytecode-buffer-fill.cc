@@ -0,0 +1,117 @@
+#include <catch.hpp>
+#include "bytecode_buffer.h"
+
+SCENARIO("A BB row is written a few bytecodes per cycle once its block returns") {
+  using namespace std::literals;
+  auto [early_restart, str] = GENERATE(table<bool, std::string_view>({std::pair{false, "in order"sv}, std::pair{true, "with early restart"sv}}));
+  GIVEN("A BB with sectored rows written two bytecodes per cycle " + std::string{str}) {
+    constexpr uint64_t fill_width = 2;
+    constexpr uint64_t block = 0x4000;
+    constexpr uint64_t demand = block + 10 * BYTECODE_SIZE; // The eleventh bytecode of the block
+    constexpr uint64_t fetch_cycle = 90;
+    constexpr uint64_t return_cycle = 100;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, true, BB_COHERENCE::NONE, fill_width, early_restart};
+    uut.initialize();
+
+    WHEN("The block of a missed bytecode returns") {
+      uut.currFetching = {true, demand};
+      uut.fetching(demand, fetch_cycle, false);
+      auto found = uut.updateBufferEntries(block, return_cycle);
+
+      if (early_restart) {
+        THEN("The missed bytecode is written first and fetch resumes on it") {
+          REQUIRE(found);
+          REQUIRE(uut.inBuffer(demand));
+          REQUIRE(uut.stats.totalMissWait == return_cycle - fetch_cycle);
+        }
+
+        THEN("The cycles it would have waited for the ten bytecodes in front of it are saved") {
+          REQUIRE(uut.stats.early_restarts == 1);
+          REQUIRE(uut.stats.early_restart_saved == 10 / fill_width);
+        }
+
+        THEN("The bytecode in front of it waits until the write wraps around") {
+          REQUIRE_FALSE(uut.inBuffer(demand - BYTECODE_SIZE));
+          REQUIRE(uut.currentlyFetching(demand - BYTECODE_SIZE));
+          REQUIRE_FALSE(uut.shouldFetch(demand - BYTECODE_SIZE));
+        }
+      } else {
+        THEN("Only the first two bytecodes are written") {
+          REQUIRE_FALSE(found);
+          REQUIRE(uut.inBuffer(block + BYTECODE_SIZE));
+          REQUIRE_FALSE(uut.inBuffer(block + 2 * BYTECODE_SIZE));
+          REQUIRE(uut.stats.early_restarts == 0);
+        }
+
+        AND_WHEN("The row is written on") {
+          std::vector<bool> resumed;
+          for (auto cycle = return_cycle + 1; cycle <= return_cycle + 5; ++cycle)
+            resumed.push_back(uut.writeRows(cycle));
+
+          THEN("Fetch resumes in the cycle the missed bytecode is written") {
+            REQUIRE(resumed == std::vector<bool>{false, false, false, false, true});
+            REQUIRE(uut.stats.totalMissWait == return_cycle + 5 - fetch_cycle);
+            REQUIRE(uut.stats.early_restart_saved == 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A BB row written all at once restarts fetch when its block returns") {
+  GIVEN("A BB without a fill width") {
+    constexpr uint64_t bpc = 0x4010;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, false, BB_COHERENCE::NONE, 0, true};
+    uut.initialize();
+
+    WHEN("The block of a missed bytecode returns") {
+      uut.currFetching = {true, bpc};
+      uut.fetching(bpc, 90, false);
+      auto found = uut.updateBufferEntries(bpc, 100);
+
+      THEN("The whole row is there and nothing is counted as saved") {
+        REQUIRE(found);
+        REQUIRE(uut.inBuffer(bpc + 7 * BYTECODE_SIZE));
+        REQUIRE(uut.stats.early_restarts == 0);
+        REQUIRE(uut.stats.totalMissWait == 10);
+      }
+    }
+  }
+}
+
+SCENARIO("A BB fill in flight across a context switch returns into its row") {
+  using namespace std::literals;
+  auto [flush, str] = GENERATE(table<bool, std::string_view>({std::pair{false, "partitioned"sv}, std::pair{true, "flushed"sv}}));
+  GIVEN("A BB whose rows are " + std::string{str} + " on a context switch") {
+    constexpr uint64_t bpc = 0x4010;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, false, BB_COHERENCE::NONE, 0, false};
+    uut.initialize();
+    uut.contextSwitch(0, flush);
+
+    WHEN("The address space switches while a row is fetching and the block returns before it switches back") {
+      uut.fetching(bpc, 90, true);
+      uut.contextSwitch(1, flush);
+      bool needed = uut.blockIsNeeded(bpc);
+      if (needed)
+        uut.updateBufferEntries(bpc, 100);
+      bool other_sees_it = uut.inBuffer(bpc);
+      auto retained = uut.contextSwitch(0, flush);
+
+      if (flush) {
+        THEN("The fill was dropped and nothing is there") {
+          REQUIRE_FALSE(needed);
+          REQUIRE(retained == 0);
+          REQUIRE_FALSE(uut.inBuffer(bpc));
+        }
+      } else {
+        THEN("Only the address space that fetched the row finds it") {
+          REQUIRE(needed);
+          REQUIRE_FALSE(other_sees_it);
+          REQUIRE(retained == 1);
+          REQUIRE(uut.inBuffer(bpc));
+        }
+      }
+    }
+  }
+}
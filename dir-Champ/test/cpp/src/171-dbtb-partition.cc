@@ -0,0 +1,50 @@
+#include <catch.hpp>
+#include "bytecode_module.h"
+
+SCENARIO("A partitioned DBTB keeps a slot per address space for an opcode") {
+  GIVEN("A DBTB shared by two address spaces") {
+    constexpr int opcode = 0x71;
+    constexpr int64_t first_jump = 6 * BYTECODE_SIZE;
+    constexpr int64_t second_jump = -10 * BYTECODE_SIZE;
+    BYTECODE_BTB uut{BYTECODE_BTB_SIZE};
+
+    WHEN("Both address spaces learn a different jump for the same opcode") {
+      uut.contextSwitch(0, false);
+      uut.update(opcode, 0, first_jump);
+      uut.contextSwitch(1, false);
+      uut.update(opcode, 0, second_jump);
+
+      THEN("Each predicts its own jump after switching back") {
+        REQUIRE(uut.prediction(opcode, 0) == second_jump);
+        REQUIRE(uut.contextSwitch(0, false) == 1);
+        REQUIRE(uut.prediction(opcode, 0) == first_jump);
+        REQUIRE(uut.slot_conflicts == 0);
+      }
+    }
+
+    WHEN("The other address space's opcode hashes to the same slot") {
+      constexpr int other_opcode = opcode ^ 0x9D;
+      uut.contextSwitch(0, false);
+      uut.update(opcode, 0, first_jump);
+      uut.contextSwitch(1, false);
+      uut.update(other_opcode, 0, second_jump);
+
+      THEN("It takes the slot over and the conflict is counted") {
+        REQUIRE(uut.slot_conflicts == 1);
+        REQUIRE(uut.contextSwitch(0, false) == 0);
+        REQUIRE(uut.prediction(opcode, 0) == 0);
+      }
+    }
+
+    WHEN("The table is flushed on the switch") {
+      uut.contextSwitch(0, false);
+      uut.update(opcode, 0, first_jump);
+
+      THEN("Nothing is left for either address space") {
+        REQUIRE(uut.contextSwitch(1, true) == 0);
+        REQUIRE(uut.contextSwitch(0, false) == 0);
+        REQUIRE(uut.prediction(opcode, 0) == 0);
+      }
+    }
+  }
+}
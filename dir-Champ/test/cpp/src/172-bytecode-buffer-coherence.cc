@@ -0,0 +1,100 @@
+#include <catch.hpp>
+#include "bytecode_buffer.h"
+
+SCENARIO("A store invalidates every BB row holding a bytecode it covers") {
+  GIVEN("A BB that drops rows on stores, holding two neighbouring rows") {
+    constexpr uint64_t first_row = 0x4000;
+    // A row holds the bytecodes from its fetch address up to and including rowSize() bytecodes on
+    constexpr uint64_t second_row = first_row + (BYTECODE_BUFFER_SIZE + 1) * BYTECODE_SIZE;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, false, BB_COHERENCE::INVALIDATE, 0, false};
+    uut.initialize();
+    uut.fetching(first_row, 90, false);
+    uut.fetching(second_row, 90, false);
+    uut.updateBufferEntries(first_row, 100);
+    REQUIRE(uut.inBuffer(first_row));
+    REQUIRE(uut.inBuffer(second_row));
+
+    WHEN("A word is stored over the last bytecode of the first row") {
+      auto snooped = uut.snoopStore(second_row - BYTECODE_SIZE, BB_STORE_BYTES);
+
+      THEN("Both rows the word covers are dropped") {
+        REQUIRE(snooped);
+        REQUIRE_FALSE(uut.inBuffer(first_row));
+        REQUIRE_FALSE(uut.inBuffer(second_row));
+        REQUIRE(uut.stats.coherence_invalidations == 2);
+      }
+    }
+
+    WHEN("A bytecode is stored past both rows") {
+      auto snooped = uut.snoopStore(second_row + (BYTECODE_BUFFER_SIZE + 1) * BYTECODE_SIZE, BYTECODE_SIZE);
+
+      THEN("Neither row is touched") {
+        REQUIRE_FALSE(snooped);
+        REQUIRE(uut.inBuffer(first_row));
+        REQUIRE(uut.inBuffer(second_row));
+      }
+    }
+  }
+}
+
+SCENARIO("A store into a BB row in flight drops it once its block returns") {
+  GIVEN("A BB that drops rows on stores, fetching a row") {
+    constexpr uint64_t row = 0x4000;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, false, BB_COHERENCE::INVALIDATE, 0, false};
+    uut.initialize();
+    uut.fetching(row, 90, false);
+
+    WHEN("A word is stored into the row before its block returns") {
+      auto snooped = uut.snoopStore(row + 2 * BYTECODE_SIZE, BB_STORE_BYTES);
+      uut.updateBufferEntries(row, 100);
+
+      THEN("The block brings the old code units, so the row is dropped and fetched again") {
+        REQUIRE(snooped);
+        REQUIRE(uut.stats.coherence_inflight == 1);
+        REQUIRE(uut.stats.coherence_invalidations == 1);
+        REQUIRE_FALSE(uut.inBuffer(row));
+        REQUIRE(uut.shouldFetch(row));
+      }
+    }
+  }
+}
+
+SCENARIO("A store into an updated BB row rewrites the slots it covers") {
+  GIVEN("A BB that updates rows on stores, written two bytecodes per cycle") {
+    constexpr uint64_t row = 0x4000;
+    constexpr uint64_t store = row + 2 * BYTECODE_SIZE;
+    constexpr uint64_t return_cycle = 100;
+    BYTECODE_BUFFER uut{6, 8, 0, 2, 0, false, BB_COHERENCE::UPDATE, 2, false};
+    uut.initialize();
+    uut.fetching(row, 90, false);
+    uut.updateBufferEntries(row, return_cycle);
+    for (auto cycle = return_cycle + 1; cycle <= return_cycle + 4; ++cycle)
+      uut.writeRows(cycle);
+    REQUIRE(uut.inBuffer(row + BYTECODE_BUFFER_SIZE * BYTECODE_SIZE));
+
+    WHEN("A word is stored into the row") {
+      auto snooped = uut.snoopStore(store, BB_STORE_BYTES);
+
+      THEN("The row stays, but the four stored slots wait to be written again") {
+        REQUIRE(snooped);
+        REQUIRE(uut.stats.coherence_updates == 1);
+        REQUIRE(uut.inBuffer(row));
+        REQUIRE_FALSE(uut.inBuffer(store));
+        REQUIRE_FALSE(uut.inBuffer(store + 3 * BYTECODE_SIZE));
+        REQUIRE(uut.currentlyFetching(store));
+        REQUIRE_FALSE(uut.shouldFetch(store));
+      }
+
+      AND_WHEN("Two cycles of writes go by") {
+        uut.writeRows(return_cycle + 5);
+        uut.writeRows(return_cycle + 6);
+
+        THEN("The whole row is there again") {
+          REQUIRE(uut.inBuffer(store));
+          REQUIRE(uut.inBuffer(store + 3 * BYTECODE_SIZE));
+          REQUIRE_FALSE(uut.currentlyFetching(store));
+        }
+      }
+    }
+  }
+}
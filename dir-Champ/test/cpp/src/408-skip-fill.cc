@@ -0,0 +1,169 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+SCENARIO("A cache passes a skip_fill miss through without allocating a block") {
+  GIVEN("An empty cache") {
+    constexpr uint64_t hit_latency = 4;
+    constexpr uint64_t fill_latency = 2;
+    constexpr uint64_t miss_latency = 3;
+    do_nothing_MRC mock_ll{miss_latency};
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("408-uut-pass")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &uut, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    // Run the uut for a few cycles
+    for (auto i = 0; i < 10; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+
+    WHEN("A packet that skips the fill is sent") {
+      uint64_t id = 1;
+      decltype(mock_ul)::request_type test_a;
+      test_a.address = 0xdeadbeef;
+      test_a.cpu = 0;
+      test_a.type = access_type::LOAD;
+      test_a.skip_fill = true;
+      test_a.instr_id = id++;
+
+      auto test_a_result = mock_ul.issue(test_a);
+
+      for (uint64_t i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The issue is received and forwarded to the lower level") {
+        CHECK(test_a_result);
+        REQUIRE(mock_ll.packet_count() == 1);
+        REQUIRE(mock_ll.addresses.back() == test_a.address);
+      }
+
+      THEN("The response is still returned") {
+        REQUIRE(std::size(mock_ul.packets) == 1);
+        REQUIRE(mock_ul.packets.front().return_time == mock_ul.packets.front().issue_time + (fill_latency + miss_latency + hit_latency + 1)); // +1 due to ordering of elements
+      }
+
+      AND_WHEN("A packet with the same address is sent") {
+        decltype(mock_ul)::request_type test_b = test_a;
+        test_b.skip_fill = false;
+        test_b.instr_id = id++;
+
+        auto test_b_result = mock_ul.issue(test_b);
+
+        for (uint64_t i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("It misses, no way was allocated for the first one") {
+          CHECK(test_b_result);
+          REQUIRE(mock_ll.packet_count() == 2);
+          REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("A skip_fill miss merged with a request that fills allocates a block") {
+  auto skipping_first = GENERATE(true, false);
+  GIVEN("An empty cache") {
+    constexpr uint64_t hit_latency = 4;
+    constexpr uint64_t fill_latency = 2;
+    constexpr uint64_t miss_latency = 10;
+    do_nothing_MRC mock_ll{miss_latency};
+    to_rq_MRP mock_ul_seed;
+    to_rq_MRP mock_ul_test;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name(std::string{"408-uut-merge-"} + (skipping_first ? "skip-first" : "skip-second"))
+      .upper_levels({{&mock_ul_seed.queues, &mock_ul_test.queues}})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &uut, &mock_ul_seed, &mock_ul_test}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    // Run the uut for a few cycles
+    for (auto i = 0; i < 10; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+
+    WHEN("A packet that skips the fill and one that does not are sent to the same address before the fill has completed") {
+      uint64_t id = 1;
+      decltype(mock_ul_seed)::request_type test_a;
+      test_a.address = 0xdeadbeef;
+      test_a.cpu = 0;
+      test_a.type = access_type::LOAD;
+      test_a.skip_fill = skipping_first;
+      test_a.instr_id = id++;
+
+      auto test_a_result = mock_ul_seed.issue(test_a);
+
+      for (uint64_t i = 0; i < hit_latency + 2; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      decltype(mock_ul_test)::request_type test_b = test_a;
+      test_b.skip_fill = !skipping_first;
+      test_b.instr_id = id++;
+
+      auto test_b_result = mock_ul_test.issue(test_b);
+
+      for (uint64_t i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("Both issues are received and only one is forwarded") {
+        CHECK(test_a_result);
+        CHECK(test_b_result);
+        REQUIRE(mock_ll.packet_count() == 1);
+      }
+
+      THEN("Both upper levels receive their return") {
+        REQUIRE(std::size(mock_ul_seed.packets) == 1);
+        REQUIRE(std::size(mock_ul_test.packets) == 1);
+        REQUIRE(mock_ul_seed.packets.front().return_time > 0);
+        REQUIRE(mock_ul_test.packets.front().return_time == mock_ul_seed.packets.front().return_time);
+      }
+
+      AND_WHEN("A packet with the same address is sent") {
+        decltype(mock_ul_test)::request_type test_c = test_a;
+        test_c.skip_fill = false;
+        test_c.instr_id = id++;
+
+        auto test_c_result = mock_ul_test.issue(test_c);
+
+        for (uint64_t i = 0; i < 100; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        THEN("It hits, the merge cleared the flag") {
+          CHECK(test_c_result);
+          REQUIRE(mock_ll.packet_count() == 1);
+          REQUIRE(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,204 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t rrip_sets = 64;
+  constexpr uint32_t rrip_ways = 2;
+  // Leader sets per policy, as bytecode_rrip chooses them
+  constexpr std::size_t rrip_leaders = std::min<std::size_t>(32, rrip_sets / (2 * 4 * NUM_CPUS));
+
+  uint64_t first_address(uint32_t set) { return uint64_t{2 * set} << LOG2_BLOCK_SIZE; }
+
+  // Fills way 0 of the set with a block of the given load type and way 1 with plain data, then asks for a victim.
+  // The data goes in at the DRRIP insertion position, so way 0 is kept only if it went in protected.
+  // An instruction fill has its ip in the block.
+  bool protects(CACHE& uut, uint32_t set, LOAD_TYPE ld_type, bool instruction = false)
+  {
+    auto& first = uut.block[set * rrip_ways];
+    auto& second = uut.block[set * rrip_ways + 1];
+    first.valid = second.valid = true;
+    first.ld_type = ld_type;
+    first.bytecode = (ld_type == LOAD_TYPE::BLW || ld_type == LOAD_TYPE::BTG);
+    second.ld_type = LOAD_TYPE::STANDARD_DATA;
+    second.bytecode = false;
+    first.address = first.v_address = first_address(set);
+    second.address = second.v_address = (uint64_t{2 * set + 1} << LOG2_BLOCK_SIZE);
+
+    uut.impl_update_replacement_state(0, set, 0, first.address, instruction ? first.address : 0, 0, champsim::to_underlying(access_type::LOAD), false);
+    uut.impl_update_replacement_state(0, set, 1, second.address, 0, 0, champsim::to_underlying(access_type::LOAD), false);
+    return uut.impl_find_victim(0, 0, set, &first, 0, 0, champsim::to_underlying(access_type::LOAD)) == 1;
+  }
+
+  std::vector<uint32_t> protecting_sets(CACHE& uut, LOAD_TYPE ld_type)
+  {
+    std::vector<uint32_t> result;
+    for (uint32_t set = 0; set < rrip_sets; ++set) {
+      if (protects(uut, set, ld_type))
+        result.push_back(set);
+    }
+    return result;
+  }
+
+  // Fills way 0 with the instruction block protects() uses and hits on it, once per fill
+  void reuse_instruction(CACHE& uut, uint32_t set, int fills)
+  {
+    auto& filled = uut.block[set * rrip_ways];
+    filled.valid = true;
+    filled.ld_type = LOAD_TYPE::NOT_IMPLEMENTED;
+    filled.bytecode = false;
+    filled.address = filled.v_address = first_address(set);
+    for (auto i = 0; i < fills; ++i) {
+      uut.impl_update_replacement_state(0, set, 0, filled.address, filled.address, 0, champsim::to_underlying(access_type::LOAD), false);
+      uut.impl_update_replacement_state(0, set, 0, filled.address, filled.address, 0, champsim::to_underlying(access_type::LOAD), true);
+    }
+  }
+
+  // A data miss in each of the given sets, each a fill that trains the duel if the set leads
+  void miss_in(CACHE& uut, const std::vector<uint32_t>& sets, int rounds)
+  {
+    for (auto i = 0; i < rounds; ++i) {
+      for (auto set : sets) {
+        auto& filled = uut.block[set * rrip_ways];
+        filled.ld_type = LOAD_TYPE::STANDARD_DATA;
+        filled.bytecode = false;
+        uut.impl_update_replacement_state(0, set, 0, filled.address, 0, 0, champsim::to_underlying(access_type::LOAD), false);
+      }
+    }
+  }
+}
+
+SCENARIO("bytecode_rrip protects bytecode and dispatch table fills") {
+  using namespace std::literals;
+  auto [ld_type, str] = GENERATE(table<LOAD_TYPE, std::string_view>({std::pair{LOAD_TYPE::BLW, "BLW"sv}, std::pair{LOAD_TYPE::BTG, "BTG"sv}}));
+  GIVEN("A cache with bytecode_rrip where the protection duel has not been trained") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("443a-uut-"+std::string{str})
+      .sets(rrip_sets)
+      .ways(rrip_ways)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .replacement<CACHE::rreplacementDbytecode_rrip>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    WHEN("A " + std::string{str} + " fill and a data fill go into each set") {
+      auto protecting = protecting_sets(uut, ld_type);
+
+      THEN("The " + std::string{str} + " line outlives the data in the leader sets of protection") {
+        REQUIRE(std::size(protecting) == rrip_leaders);
+      }
+    }
+
+    WHEN("Two data fills go into each set") {
+      auto protecting = protecting_sets(uut, LOAD_TYPE::STANDARD_DATA);
+
+      THEN("No set protects the first") {
+        REQUIRE(std::empty(protecting));
+      }
+    }
+  }
+}
+
+SCENARIO("bytecode_rrip turns protection on and off with the misses of its leader sets") {
+  GIVEN("A cache with bytecode_rrip and its leader sets of protection") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("443b-uut")
+      .sets(rrip_sets)
+      .ways(rrip_ways)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .replacement<CACHE::rreplacementDbytecode_rrip>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto protect_leaders = protecting_sets(uut, LOAD_TYPE::BLW);
+    REQUIRE(std::size(protect_leaders) == rrip_leaders);
+
+    std::vector<uint32_t> others;
+    for (uint32_t set = 0; set < rrip_sets; ++set) {
+      if (std::find(std::begin(protect_leaders), std::end(protect_leaders), set) == std::end(protect_leaders))
+        others.push_back(set);
+    }
+
+    WHEN("The sets that do not protect keep missing") {
+      miss_in(uut, others, 200);
+
+      THEN("Every set protects but the leader sets of the baseline") {
+        REQUIRE(std::size(protecting_sets(uut, LOAD_TYPE::BLW)) == rrip_sets - rrip_leaders);
+      }
+
+      AND_WHEN("The leader sets of protection keep missing") {
+        miss_in(uut, protect_leaders, 200);
+
+        THEN("Protection falls back to the leader sets of protection") {
+          REQUIRE(protecting_sets(uut, LOAD_TYPE::BLW) == protect_leaders);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("bytecode_rrip protects instruction lines whose block keeps being reused") {
+  using namespace std::literals;
+  auto [earlier_fills, str] = GENERATE(table<int, std::string_view>({std::pair{0, "no earlier fill"sv}, std::pair{1, "one earlier fill"sv}, std::pair{2, "two earlier fills"sv}}));
+  GIVEN("A cache with bytecode_rrip and its leader sets of protection") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("443c-uut-"+std::string{str})
+      .sets(rrip_sets)
+      .ways(rrip_ways)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .replacement<CACHE::rreplacementDbytecode_rrip>()
+    };
+
+    std::array<champsim::operable*, 3> elements{{&mock_ll, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto protect_leaders = protecting_sets(uut, LOAD_TYPE::BLW);
+    REQUIRE(std::size(protect_leaders) == rrip_leaders);
+
+    WHEN("An instruction line is filled after its block was hit in " + std::string{str}) {
+      for (auto set : protect_leaders)
+        reuse_instruction(uut, set, earlier_fills);
+
+      auto protecting = std::count_if(std::begin(protect_leaders), std::end(protect_leaders),
+                                      [&uut](auto set) { return protects(uut, set, LOAD_TYPE::NOT_IMPLEMENTED, true); });
+
+      THEN("It is protected only once the block has been reused twice") {
+        REQUIRE(static_cast<std::size_t>(protecting) == (earlier_fills >= 2 ? std::size(protect_leaders) : 0));
+      }
+    }
+  }
+}
@@ -0,0 +1,177 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "bytecode_opcodes.h"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "defaults.hpp"
+
+SCENARIO("The bytecode_operand prefetcher prefetches the local a LOAD_FAST reads once it has learnt it") {
+  constexpr int oparg = 20;
+  constexpr uint64_t frame_base = 0xdead'0000;
+  constexpr uint64_t local_address = frame_base + 8 * oparg; // In the block after the frame base
+  constexpr uint64_t bpc = 0xbeef'0040;
+
+  GIVEN("A cache with the operand prefetcher that has seen a LOAD_FAST and its load three times") {
+    do_nothing_MRC mock_ll;
+    do_nothing_MRC mock_lt;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("454-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .lower_translate(&mock_lt.queues)
+      .set_virtual_prefetch()
+      .prefetcher<CACHE::pprefetcherDbytecode_operand>()
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &mock_lt, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    static uint64_t id = 1;
+    auto run = [&]() {
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    };
+
+    // The core hands the bytecode over at its BLW, then its handler reads the local
+    auto execute = [&]() {
+      uut.bytecode_operate(bpc, id++, bytecode_opcode::LOAD_FAST, oparg, false);
+
+      decltype(mock_ul)::request_type load;
+      load.address = local_address;
+      load.v_address = local_address;
+      load.ip = 0xcafecafe;
+      load.instr_id = id++;
+      load.cpu = 0;
+      load.is_translated = true;
+      load.ld_type = LOAD_TYPE::STANDARD_DATA;
+      auto result = mock_ul.issue(load);
+      run();
+      return result;
+    };
+
+    auto issued = execute() && execute() && execute();
+    THEN("The loads are accepted") {
+      REQUIRE(issued);
+    }
+
+    THEN("Nothing is prefetched while the delta is being learnt") {
+      REQUIRE(uut.sim_stats.pf_issued == 0);
+      REQUIRE(std::empty(mock_lt.addresses));
+    }
+
+    WHEN("The same bytecode is handed over again") {
+      uut.bytecode_operate(bpc, id++, bytecode_opcode::LOAD_FAST, oparg, false);
+      run();
+
+      THEN("The block of the local is prefetched") {
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+        REQUIRE(std::size(mock_lt.addresses) == 1);
+        REQUIRE((mock_lt.addresses.front() >> LOG2_BLOCK_SIZE) == (local_address >> LOG2_BLOCK_SIZE));
+      }
+    }
+
+    WHEN("A LOAD_FAST of another local is handed over") {
+      uut.bytecode_operate(bpc + 2, id++, bytecode_opcode::LOAD_FAST, oparg + 1, false);
+      run();
+
+      THEN("Nothing is prefetched") {
+        REQUIRE(uut.sim_stats.pf_issued == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("The bytecode_operand prefetcher learns from first loads that arrive out of order") {
+  constexpr int oparg = 20;
+  constexpr uint64_t frame_base = 0xdead'0000;
+  constexpr uint64_t bpc = 0xbeef'0040;
+
+  GIVEN("A cache with the operand prefetcher") {
+    do_nothing_MRC mock_ll;
+    do_nothing_MRC mock_lt;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("454b-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .lower_translate(&mock_lt.queues)
+      .set_virtual_prefetch()
+      .prefetcher<CACHE::pprefetcherDbytecode_operand>()
+    };
+
+    std::array<champsim::operable*, 4> elements{{&mock_ll, &mock_lt, &mock_ul, &uut}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    auto run = [&]() {
+      for (auto i = 0; i < 100; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+    };
+
+    auto load = [&](uint64_t address, uint64_t instr_id) {
+      decltype(mock_ul)::request_type request;
+      request.address = address;
+      request.v_address = address;
+      request.ip = 0xcafecafe;
+      request.instr_id = instr_id;
+      request.cpu = 0;
+      request.is_translated = true;
+      request.ld_type = LOAD_TYPE::STANDARD_DATA;
+      auto result = mock_ul.issue(request);
+      run();
+      return result;
+    };
+
+    WHEN("Two LOAD_FASTs are handed over three times and the second one's load always comes first") {
+      bool issued = true;
+      for (uint64_t round = 0; round < 3; ++round) {
+        auto id = 100 * (round + 1);
+        uut.bytecode_operate(bpc, id, bytecode_opcode::LOAD_FAST, oparg, false);
+        uut.bytecode_operate(bpc + 2, id + 10, bytecode_opcode::LOAD_FAST, oparg + 1, false);
+        issued = issued && load(frame_base + 8 * (oparg + 1), id + 11);
+        issued = issued && load(frame_base + 8 * oparg, id + 1);
+      }
+      REQUIRE(issued);
+      REQUIRE(uut.sim_stats.pf_issued == 0);
+
+      AND_WHEN("The first one is handed over again") {
+        uut.bytecode_operate(bpc, 1000, bytecode_opcode::LOAD_FAST, oparg, false);
+        run();
+
+        THEN("Its local is prefetched, as its late loads were learnt from") {
+          REQUIRE(uut.sim_stats.pf_issued == 1);
+          REQUIRE((mock_lt.addresses.back() >> LOG2_BLOCK_SIZE) == ((frame_base + 8 * oparg) >> LOG2_BLOCK_SIZE));
+        }
+      }
+    }
+
+    WHEN("A learnt LOAD_FAST is handed over as its BB row fills, then at its BLW") {
+      for (uint64_t round = 0; round < 3; ++round) {
+        uut.bytecode_operate(bpc, 100 * (round + 1), bytecode_opcode::LOAD_FAST, oparg, false);
+        load(frame_base + 8 * oparg, 100 * (round + 1) + 1);
+      }
+      uut.bytecode_operate(bpc, 0, bytecode_opcode::LOAD_FAST, oparg, true);
+      run();
+      auto at_fill = uut.sim_stats.pf_issued;
+      uut.bytecode_operate(bpc, 1000, bytecode_opcode::LOAD_FAST, oparg, false);
+      run();
+
+      THEN("The local is prefetched at the fill and not again at the BLW") {
+        REQUIRE(at_fill == 1);
+        REQUIRE(uut.sim_stats.pf_issued == 1);
+      }
+    }
+  }
+}
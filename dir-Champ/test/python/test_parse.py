@@ -450,7 +450,7 @@ class NormalizeConfigTest(unittest.TestCase):
         self.assertEqual(vmem.get('__test__'), True)
 
     def test_core_params_are_moved_to_core_array(self):
-        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB', 'bytecode_buffer', 'bytecode_hdbt', 'bytecode_btb', 'bytecode_ras', 'bytecode_fusion', 'bytecode_loop', 'bytecode_l1', 'bytecode_context_switch')
         for k in core_keys_to_copy:
             with self.subTest(key=k):
                 cores, caches, ptws, pmem, vmem = config.parse.normalize_config({ k: '__test__' })
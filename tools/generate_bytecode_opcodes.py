@@ -0,0 +1,54 @@
+import os
+import re
+import sys
+
+# Writes dir-Champ/inc/bytecode_opcodes.h from the opcode.h of the bundled interpreter, so the simulator
+# names and classifies bytecodes with the numbering the traces were recorded with.
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OPCODE_H = os.path.join(ROOT, 'Cpython-dir', 'Include', 'opcode.h')
+OUTPUT = os.path.join(ROOT, 'dir-Champ', 'inc', 'bytecode_opcodes.h')
+
+# Shares its value with STORE_NAME, it is the threshold for opcodes with an argument
+NOT_OPCODES = {'HAVE_ARGUMENT'}
+
+
+def read_opcodes(path):
+    opcodes = []
+    define_pattern = re.compile(r'#define (\w+)\s+(\d+)\s*$')
+    with open(path, 'r') as file:
+        for line in file:
+            if line.startswith('#define NB_'):
+                break
+            match = define_pattern.match(line)
+            if match and match.group(1) not in NOT_OPCODES:
+                opcodes.append((match.group(1), int(match.group(2))))
+    return opcodes
+
+
+def write_header(opcodes, path):
+    names = [''] * 256
+    for name, value in opcodes:
+        names[value] = name
+    width = max(len(name) for name, _ in opcodes)
+
+    with open(path, 'w') as out:
+        out.write('// Generated by tools/generate_bytecode_opcodes.py from Cpython-dir/Include/opcode.h, do not edit\n\n')
+        out.write('#ifndef BYTECODE_OPCODES_H\n#define BYTECODE_OPCODES_H\n\n')
+        out.write('#include <array>\n#include <string_view>\n\n')
+        out.write('namespace bytecode_opcode\n{\n')
+        for name, value in sorted(opcodes, key=lambda opcode: opcode[1]):
+            out.write(f'constexpr int {name:<{width}} = {value};\n')
+        out.write('\n// Indexed by opcode, empty for values the interpreter does not use\n')
+        out.write('constexpr std::array<std::string_view, 256> names{\n')
+        for value in range(0, 256, 4):
+            row = ', '.join(f'"{name}"' for name in names[value:value + 4])
+            out.write(f'    {row},\n')
+        out.write('};\n} // namespace bytecode_opcode\n\n#endif\n')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1:
+        print("Usage: python generate_bytecode_opcodes.py")
+    else:
+        write_header(read_opcodes(OPCODE_H), OUTPUT)
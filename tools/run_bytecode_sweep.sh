@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# List of trace files
+trace_files=("binary_trees.trace" "nbody.trace" "fasta.trace" "knucleotide.trace" "recog_thread.trace" "decoder_thread.2.trace" "mandelbrot.trace" "spectralnorm.trace" "fannkuch-redux.trace")
+
+# Arguments
+instrs_to_run=$1
+instr_to_skip=$2
+log_name=$3
+
+# Directory paths (update these as needed)
+LOGS_DIR="logs"
+CONFIG_TESTED="bytecode_sweep"
+
+# Create directories if they do not exist
+mkdir -p $LOGS_DIR
+mkdir -p "${LOGS_DIR}/${CONFIG_TESTED}"
+
+# One pass per trace covers every BB, HDBT and DBTB size of run_bb_size_simulations.sh and run_hdbt_dbtb_size.sh
+for trace_file in "${trace_files[@]}"; do
+    trace_file_base=$(basename "$trace_file" .trace)
+    echo "Running sweep for trace file: " $trace_file
+    log_file="${LOGS_DIR}/${CONFIG_TESTED}/${trace_file_base}_${log_name}"
+
+    # Check if log file already exists
+    if [ -f "$log_file" ]; then
+        echo "Log file $log_file already exists. Skipping..."
+        continue
+    fi
+    # Run the command
+    bin/bytecode-sweep --warmup-instructions $instr_to_skip --simulation-instructions $instrs_to_run \
+        --hdbt 2x4 4x4 8x4 16x4 32x4 64x4 --dbtb 0 8 16 32 64 128 256 $TRACES_ROOT/$trace_file >> $log_file
+done
@@ -29,23 +29,23 @@ for trace_file in "${trace_files[@]}"; do
     if [ "$bin" == "ideal" ]; then
         json_log_name="${JSON_DIR}/${trace_file_base}_${log_name}_ideal"
         log_file="${LOGS_DIR}/${trace_file_base}_${log_name}_ideal"
-        command="bin/champsim_ideal"
+        command="bin/champsim --dispatch-mode ideal"
     elif [ "$bin" == "skip" ]; then
         json_log_name="${JSON_DIR}/${trace_file_base}_${log_name}_skip"
         log_file="${LOGS_DIR}/${trace_file_base}_${log_name}_skip"
-        command="bin/champsim_skip"
+        command="bin/champsim --dispatch-mode skip"
     elif [ "$bin" == "l2" ]; then
         json_log_name="${JSON_DIR}/${trace_file_base}_${log_name}_l2"
         log_file="${LOGS_DIR}/${trace_file_base}_${log_name}_l2"
-        command="bin/champsim_l2"
+        command="bin/champsim --dispatch-mode skip --fill-level L2C"
     elif  [ "$bin" == "no_skip" ]; then
         json_log_name="${JSON_DIR}/${trace_file_base}_${log_name}"
         log_file="${LOGS_DIR}/${trace_file_base}_${log_name}"
-        command="bin/champsim_no_skip"
+        command="bin/champsim --dispatch-mode no-skip"
     elif  [ "$bin" == "minimal" ]; then
         json_log_name="${JSON_DIR}/${trace_file_base}_${log_name}_minimal"
         log_file="${LOGS_DIR}/${trace_file_base}_${log_name}_minimal"
-        command="bin/champsim_minimal"
+        command="bin/champsim --dispatch-mode minimal"
     else 
         echo "Not a valid option: " $bin 
     fi